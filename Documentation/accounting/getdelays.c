@@ -199,6 +199,8 @@ static void print_delayacct(struct taskstats *t)
 	       "SWAP  %15s%15s\n"
 	       "      %15llu%15llu\n"
 	       "RECLAIM  %12s%15s\n"
+	       "      %15llu%15llu\n"
+	       "COMPACT  %12s%15s\n"
 	       "      %15llu%15llu\n",
 	       "count", "real total", "virtual total", "delay total",
 	       (unsigned long long)t->cpu_count,
@@ -213,7 +215,10 @@ static void print_delayacct(struct taskstats *t)
 	       (unsigned long long)t->swapin_delay_total,
 	       "count", "delay total",
 	       (unsigned long long)t->freepages_count,
-	       (unsigned long long)t->freepages_delay_total);
+	       (unsigned long long)t->freepages_delay_total,
+	       "count", "delay total",
+	       (unsigned long long)t->compact_count,
+	       (unsigned long long)t->compact_delay_total);
 }
 
 static void task_context_switch_counts(struct taskstats *t)
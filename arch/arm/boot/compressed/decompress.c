@@ -0,0 +1,36 @@
+/*
+ * linux/arch/arm/boot/compressed/decompress.c
+ *
+ * Pulls in the decompressor selected by the kernel compression mode,
+ * built for the pre-boot environment.  misc.c provides the memory
+ * helpers, error() and the malloc arena.
+ */
+
+#define _LINUX_STRING_H_
+
+#include <linux/compiler.h>	/* for inline */
+#include <linux/types.h>	/* for size_t */
+#include <linux/stddef.h>	/* for NULL */
+#include <linux/linkage.h>
+#include <asm/string.h>
+
+extern unsigned long free_mem_ptr;
+extern unsigned long free_mem_end_ptr;
+extern void error(char *);
+
+#define STATIC static
+/* No static data: it would be addressed through the unrelocated GOT */
+#define STATIC_RW_DATA	/* non-static please */
+
+#ifdef CONFIG_KERNEL_GZIP
+#include "../../../../lib/decompress_inflate.c"
+#endif
+
+#ifdef CONFIG_KERNEL_LZO
+#include "../../../../lib/decompress_unlzo.c"
+#endif
+
+int do_decompress(u8 *input, int len, u8 *output, void (*error)(char *x))
+{
+	return decompress(input, len, NULL, NULL, output, NULL, error);
+}
@@ -151,6 +151,13 @@ extern void __pgd_error(const char *file, int line, unsigned long val);
 #define SUPERSECTION_SIZE	(1UL << SUPERSECTION_SHIFT)
 #define SUPERSECTION_MASK	(~(SUPERSECTION_SIZE-1))
 
+/*
+ * ARMv6 large page (64K) address mask and size definitions.
+ */
+#define LARGE_PAGE_SHIFT	16
+#define LARGE_PAGE_SIZE		(1UL << LARGE_PAGE_SHIFT)
+#define LARGE_PAGE_MASK		(~(LARGE_PAGE_SIZE-1))
+
 /*
  * "Linux" PTE definitions.
  *
@@ -170,6 +177,11 @@ extern void __pgd_error(const char *file, int line, unsigned long val);
 #define L_PTE_USER		(1 << 8)
 #define L_PTE_EXEC		(1 << 9)
 #define L_PTE_SHARED		(1 << 10)	/* shared(v6), coherent(xsc3) */
+#ifdef CONFIG_ARM_LARGE_USER_PAGES
+#define L_PTE_LARGE		(1 << 11)	/* part of a large page (v6) */
+#else
+#define L_PTE_LARGE		0
+#endif
 
 /*
  * These are the memory types, defined to be compatible with
@@ -260,7 +272,10 @@ extern struct page *empty_zero_page;
 #define pfn_pte(pfn,prot)	(__pte(((pfn) << PAGE_SHIFT) | pgprot_val(prot)))
 
 #define pte_none(pte)		(!pte_val(pte))
-#define pte_clear(mm,addr,ptep)	set_pte_ext(ptep, __pte(0), 0)
+#define pte_clear(mm,addr,ptep)	do { \
+	break_large_pte(mm, ptep); \
+	set_pte_ext(ptep, __pte(0), 0); \
+ } while (0)
 #define pte_page(pte)		(pfn_to_page(pte_pfn(pte)))
 #define pte_offset_kernel(dir,addr)	(pmd_page_vaddr(*(dir)) + __pte_index(addr))
 
@@ -279,8 +294,38 @@ extern struct page *empty_zero_page;
 
 #define set_pte_ext(ptep,pte,ext) cpu_set_pte_ext(ptep,pte,ext)
 
+/*
+ * An entry that is part of a large page must not change on its own: the
+ * hardware expects all 16 entries of the large page to be the same.  The
+ * whole group is turned back into small pages first, after the large TLB
+ * entry has been flushed for the mm.
+ */
+#ifdef CONFIG_ARM_LARGE_USER_PAGES
+#define pte_large(pte)	((pte_val(pte) & (L_PTE_PRESENT | L_PTE_LARGE)) == \
+			 (L_PTE_PRESENT | L_PTE_LARGE))
+
+static inline pte_t pte_mksmall(pte_t pte)
+{
+	if (pte_large(pte))
+		pte_val(pte) &= ~L_PTE_LARGE;
+	return pte;
+}
+
+struct mm_struct;
+extern void __break_large_pte(struct mm_struct *mm, pte_t *ptep);
+#define break_large_pte(mm,ptep) do { \
+	if (pte_large(*(ptep))) \
+		__break_large_pte(mm, ptep); \
+ } while (0)
+#else
+#define pte_mksmall(pte)	(pte)
+#define break_large_pte(mm,ptep)	do { } while (0)
+#endif
+
 #define set_pte_at(mm,addr,ptep,pteval) do { \
-	set_pte_ext(ptep, pteval, (addr) >= TASK_SIZE ? 0 : PTE_EXT_NG); \
+	break_large_pte(mm, ptep); \
+	set_pte_ext(ptep, pte_mksmall(pteval), \
+		    (addr) >= TASK_SIZE ? 0 : PTE_EXT_NG); \
  } while (0)
 
 /*
@@ -449,6 +494,13 @@ extern pgd_t swapper_pg_dir[PTRS_PER_PGD];
 /* FIXME: this is not correct */
 #define kern_addr_valid(addr)	(1)
 
+#ifdef CONFIG_ARM_LARGE_USER_PAGES
+#define __HAVE_ARCH_MAP_PFN_RANGE_LARGE
+struct vm_area_struct;
+extern void arch_map_pfn_range_large(struct vm_area_struct *vma,
+				     unsigned long addr, unsigned long end);
+#endif
+
 #include <asm-generic/pgtable.h>
 
 /*
@@ -0,0 +1,153 @@
+/*
+ *  linux/arch/arm/mm/large-page.c
+ *
+ *  64K large pages for user mappings of physically contiguous memory.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * The Linux page tables keep one entry per 4K page.  Only the hardware
+ * entries of a large page change: all 16 of them hold the same large page
+ * descriptor, and the Linux entries are marked with L_PTE_LARGE.  Any
+ * later change to one of the entries, through set_pte_at() or
+ * pte_clear(), turns the group back into small pages first, so the rest
+ * of the mm never has to know about large pages.
+ *
+ * A TLB must never hold a small and a large entry for the same address:
+ * the result is UNPREDICTABLE, and another CPU, or a speculative walk on
+ * ARMv7, may load one while the group is half rewritten.  So both ways
+ * round the hardware entries are cleared and the TLB flushed before the
+ * new descriptors are written (break-before-make).  Meanwhile an access
+ * takes a translation fault, which finds the Linux entry unchanged under
+ * the pte lock and is retried.
+ */
+#include <linux/module.h>
+#include <linux/mm.h>
+#include <asm/cacheflush.h>
+#include <asm/pgtable.h>
+#include <asm/system.h>
+#include <asm/tlbflush.h>
+
+#define LARGE_PTRS	(LARGE_PAGE_SIZE >> PAGE_SHIFT)
+
+static void clear_hw_group(pte_t *hw)
+{
+	int i;
+
+	for (i = 0; i < LARGE_PTRS; i++)
+		hw[i] = __pte(0);
+	clean_dcache_area(hw, LARGE_PTRS * sizeof(pte_t));
+}
+
+/*
+ * Build the large page descriptor from the small page descriptor that
+ * set_pte_ext() wrote for the first page.  TEX and XN move; the address
+ * bits they take over are zero in a 64K aligned address.
+ */
+static unsigned long small_to_large(unsigned long hw)
+{
+	unsigned long large;
+
+	large = hw & (LARGE_PAGE_MASK | PTE_EXT_NG | PTE_EXT_SHARED |
+		      PTE_EXT_APX | PTE_EXT_AP_MASK | PTE_CACHEABLE |
+		      PTE_BUFFERABLE);
+	large |= PTE_EXT_LARGE_TEX((hw >> 6) & 7);
+	if (hw & PTE_EXT_XN)
+		large |= PTE_EXT_LARGE_XN;
+
+	return large | PTE_TYPE_LARGE;
+}
+
+static void map_large_page(struct vm_area_struct *vma, unsigned long addr)
+{
+	struct mm_struct *mm = vma->vm_mm;
+	unsigned long pte, large;
+	pte_t *ptep, *hw;
+	spinlock_t *ptl;
+	pgd_t *pgd;
+	pmd_t *pmd;
+	int i;
+
+	pgd = pgd_offset(mm, addr);
+	if (pgd_none(*pgd) || pgd_bad(*pgd))
+		return;
+	pmd = pmd_offset(pgd, addr);
+	if (pmd_none(*pmd) || pmd_bad(*pmd))
+		return;
+
+	ptep = pte_offset_map_lock(mm, pmd, addr, &ptl);
+	pte = pte_val(*ptep);
+	if (!(pte & L_PTE_PRESENT) || !(pte & L_PTE_YOUNG) ||
+	    pte_large(*ptep) || (pte_pfn(*ptep) & (LARGE_PTRS - 1)))
+		goto out;
+	for (i = 1; i < LARGE_PTRS; i++) {
+		if (pte_val(ptep[i]) != pte + ((unsigned long)i << PAGE_SHIFT))
+			goto out;
+	}
+
+	/*
+	 * The first write to a clean page faults to mark it dirty, which
+	 * would split the large page again.  Nothing looks at the dirty
+	 * bit of a pfn mapping, so set it now.
+	 */
+	if (pte & L_PTE_WRITE)
+		pte |= L_PTE_DIRTY;
+	set_pte_ext(ptep, __pte(pte), PTE_EXT_NG);
+
+	/* The hardware entries are PTRS_PER_PTE entries below */
+	hw = ptep - PTRS_PER_PTE;
+	if (!(pte_val(*hw) & PTE_TYPE_SMALL))
+		goto out;
+	large = small_to_large(pte_val(*hw));
+
+	/* Drop the small page TLB entries before the large one can load */
+	clear_hw_group(hw);
+	flush_tlb_range(vma, addr, addr + LARGE_PAGE_SIZE);
+
+	for (i = 0; i < LARGE_PTRS; i++) {
+		ptep[i] = __pte((pte + ((unsigned long)i << PAGE_SHIFT)) |
+				L_PTE_LARGE);
+		hw[i] = __pte(large);
+	}
+	clean_dcache_area(hw, LARGE_PTRS * sizeof(pte_t));
+out:
+	pte_unmap_unlock(ptep, ptl);
+}
+
+/*
+ * Map the 64K aligned parts of [addr, end) with large pages, wherever the
+ * physical address is 64K aligned as well and the 16 entries agree.
+ */
+void arch_map_pfn_range_large(struct vm_area_struct *vma,
+			      unsigned long addr, unsigned long end)
+{
+	if (cpu_architecture() < CPU_ARCH_ARMv6)
+		return;
+
+	for (addr = ALIGN(addr, LARGE_PAGE_SIZE);
+	     addr < end && end - addr >= LARGE_PAGE_SIZE;
+	     addr += LARGE_PAGE_SIZE)
+		map_large_page(vma, addr);
+}
+
+/*
+ * Called with the pte lock held, before the entry at ptep changes.  Turn
+ * all the entries of its large page back into small pages, once the large
+ * TLB entry is gone.  Only the mm and the pte are known here, so the
+ * whole mm is flushed; this only happens when a large page is unmapped,
+ * changed or copied, which is rare.
+ */
+void __break_large_pte(struct mm_struct *mm, pte_t *ptep)
+{
+	pte_t *first = (pte_t *)((unsigned long)ptep &
+				 ~(LARGE_PTRS * sizeof(pte_t) - 1));
+	int i;
+
+	clear_hw_group(first - PTRS_PER_PTE);
+	flush_tlb_mm(mm);
+
+	for (i = 0; i < LARGE_PTRS; i++)
+		set_pte_ext(first + i, pte_mksmall(first[i]), PTE_EXT_NG);
+}
+EXPORT_SYMBOL(__break_large_pte);
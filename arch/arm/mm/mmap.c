@@ -10,9 +10,27 @@
 #include <asm/cputype.h>
 #include <asm/system.h>
 
-#define COLOUR_ALIGN(addr,pgoff)		\
-	((((addr)+SHMLBA-1)&~(SHMLBA-1)) +	\
-	 (((pgoff)<<PAGE_SHIFT) & (SHMLBA-1)))
+#define COLOUR_ALIGN(addr,pgoff,align)			\
+	((((addr)+(align)-1)&~((align)-1)) +		\
+	 (((pgoff)<<PAGE_SHIFT) & ((align)-1)))
+
+#ifdef CONFIG_ARM_LARGE_USER_PAGES
+/*
+ * Shared mappings of character devices (framebuffer, pmem, kgsl) usually
+ * map physically contiguous memory, with a file offset that follows the
+ * physical address.  Give them the same alignment modulo 64K, so that
+ * remap_pfn_range() can use large pages.  This also satisfies SHMLBA.
+ */
+static int large_page_align(struct file *filp, unsigned long len,
+			    unsigned long flags)
+{
+	return filp && (flags & MAP_SHARED) && len >= LARGE_PAGE_SIZE &&
+		S_ISCHR(filp->f_path.dentry->d_inode->i_mode) &&
+		cpu_architecture() >= CPU_ARCH_ARMv6;
+}
+#else
+#define large_page_align(filp, len, flags)	0
+#endif
 
 /*
  * We need to ensure that shared mappings are correctly aligned to
@@ -30,9 +48,11 @@ arch_get_unmapped_area(struct file *filp, unsigned long addr,
 	struct mm_struct *mm = current->mm;
 	struct vm_area_struct *vma;
 	unsigned long start_addr;
+	unsigned long align = SHMLBA;
+	int do_align = 0;
 #ifdef CONFIG_CPU_V6
 	unsigned int cache_type;
-	int do_align = 0, aliasing = 0;
+	int aliasing = 0;
 
 	/*
 	 * We only need to do colour alignment if either the I or D
@@ -46,10 +66,14 @@ arch_get_unmapped_area(struct file *filp, unsigned long addr,
 			do_align = filp || flags & MAP_SHARED;
 	}
 #else
-#define do_align 0
 #define aliasing 0
 #endif
 
+	if (large_page_align(filp, len, flags)) {
+		do_align = 1;
+		align = LARGE_PAGE_SIZE;
+	}
+
 	/*
 	 * We enforce the MAP_FIXED case.
 	 */
@@ -65,7 +89,7 @@ arch_get_unmapped_area(struct file *filp, unsigned long addr,
 
 	if (addr) {
 		if (do_align)
-			addr = COLOUR_ALIGN(addr, pgoff);
+			addr = COLOUR_ALIGN(addr, pgoff, align);
 		else
 			addr = PAGE_ALIGN(addr);
 
@@ -83,7 +107,7 @@ arch_get_unmapped_area(struct file *filp, unsigned long addr,
 
 full_search:
 	if (do_align)
-		addr = COLOUR_ALIGN(addr, pgoff);
+		addr = COLOUR_ALIGN(addr, pgoff, align);
 	else
 		addr = PAGE_ALIGN(addr);
 
@@ -112,7 +136,7 @@ full_search:
 		        mm->cached_hole_size = vma->vm_start - addr;
 		addr = vma->vm_end;
 		if (do_align)
-			addr = COLOUR_ALIGN(addr, pgoff);
+			addr = COLOUR_ALIGN(addr, pgoff, align);
 	}
 }
 
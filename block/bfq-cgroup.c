@@ -65,6 +65,8 @@ static inline void bfq_group_init_entity(struct bfqio_cgroup *bgrp,
 	entity->ioprio_class = entity->new_ioprio_class = bgrp->ioprio_class;
 	entity->ioprio_changed = 1;
 	entity->my_sched_data = &bfqg->sched_data;
+
+	bfqg->foreground = bgrp->foreground;
 }
 
 static inline void bfq_group_set_parent(struct bfq_group *bfqg,
@@ -231,6 +233,79 @@ static struct bfq_group *bfq_find_alloc_group(struct bfq_data *bfqd,
 	return bfqg;
 }
 
+static inline struct bfq_group *bfq_bfqq_to_bfqg(struct bfq_queue *bfqq)
+{
+	return container_of(bfqq->entity.sched_data, struct bfq_group,
+			    sched_data);
+}
+
+static inline int bfq_bfqq_foreground(struct bfq_queue *bfqq)
+{
+	return bfq_bfqq_to_bfqg(bfqq)->foreground;
+}
+
+/*
+ * Bucket upper bounds (in msec) of the latency histograms; the last
+ * bucket collects everything above the last bound.
+ */
+static const unsigned int bfq_lat_bucket_ms[BFQ_LAT_BUCKETS - 1] = {
+	10, 20, 50, 100, 200, 500, 1000,
+};
+
+/**
+ * bfq_account_latency - account the completion of @rq to its group.
+ * @bfqq: the queue @rq belongs to.
+ * @rq: the completed request.
+ *
+ * The latency is measured from the time @rq entered the block layer,
+ * so it includes the time spent waiting in the scheduler.  Must be
+ * called under the queue lock.
+ */
+static void bfq_account_latency(struct bfq_queue *bfqq, struct request *rq)
+{
+	unsigned int msecs = jiffies_to_msecs(jiffies - rq->start_time);
+	int i;
+
+	for (i = 0; i < BFQ_LAT_BUCKETS - 1; i++)
+		if (msecs < bfq_lat_bucket_ms[i])
+			break;
+
+	bfq_bfqq_to_bfqg(bfqq)->lat_hist[rq_data_dir(rq)][i]++;
+}
+
+/**
+ * bfq_move_update_raising - update the weight raising of a moving queue.
+ * @bfqd: queue descriptor.
+ * @bfqq: the queue being moved.
+ * @bfqg: the group @bfqq is moving to.
+ *
+ * A queue entering a foreground group starts a weight-raising period
+ * right away, without having to be idle for bfq_raising_min_idle_time
+ * first; a queue leaving the foreground loses its raising at once, so
+ * that it does not carry it over to the background.  The new weight is
+ * applied the next time the queue is activated.
+ */
+static void bfq_move_update_raising(struct bfq_data *bfqd,
+				    struct bfq_queue *bfqq,
+				    struct bfq_group *bfqg)
+{
+	if (!bfqd->low_latency)
+		return;
+
+	if (bfqg->foreground && bfqq->raising_coeff == 1)
+		bfqq->raising_coeff = bfqd->bfq_raising_coeff;
+	else if (!bfqg->foreground && bfq_bfqq_foreground(bfqq) &&
+		 bfqq->raising_coeff > 1)
+		bfqq->raising_coeff = 1;
+	else
+		return;
+
+	bfqq->last_rais_start_finish = jiffies;
+	bfqq->entity.ioprio_changed = 1;
+	bfq_log_bfqq(bfqd, bfqq, "move: raising coeff %u",
+		     bfqq->raising_coeff);
+}
+
 /**
  * bfq_bfqq_move - migrate @bfqq to @bfqg.
  * @bfqd: queue descriptor.
@@ -265,6 +340,8 @@ static void bfq_bfqq_move(struct bfq_data *bfqd, struct bfq_queue *bfqq,
 			bfq_deactivate_bfqq(bfqd, bfqq, 0);
 	}
 
+	bfq_move_update_raising(bfqd, bfqq, bfqg);
+
 	/*
 	 * Here we use a reference to bfqg.  We don't need a refcounter
 	 * as the cgroup reference will not be dropped, so that its
@@ -518,6 +595,7 @@ static struct bfq_group *bfq_alloc_root_group(struct bfq_data *bfqd, int node)
 
 	bgrp = &bfqio_root_cgroup;
 	spin_lock_irq(&bgrp->lock);
+	bfqg->foreground = bgrp->foreground;
 	rcu_assign_pointer(bfqg->bfqd, bfqd);
 	hlist_add_head_rcu(&bfqg->group_node, &bgrp->group_data);
 	spin_unlock_irq(&bgrp->lock);
@@ -548,6 +626,7 @@ static u64 bfqio_cgroup_##__VAR##_read(struct cgroup *cgroup,		\
 SHOW_FUNCTION(weight);
 SHOW_FUNCTION(ioprio);
 SHOW_FUNCTION(ioprio_class);
+SHOW_FUNCTION(foreground);
 #undef SHOW_FUNCTION
 
 #define STORE_FUNCTION(__VAR, __MIN, __MAX)				\
@@ -586,6 +665,75 @@ STORE_FUNCTION(ioprio, 0, IOPRIO_BE_NR - 1);
 STORE_FUNCTION(ioprio_class, IOPRIO_CLASS_RT, IOPRIO_CLASS_IDLE);
 #undef STORE_FUNCTION
 
+static int bfqio_cgroup_foreground_write(struct cgroup *cgroup,
+					 struct cftype *cftype, u64 val)
+{
+	struct bfqio_cgroup *bgrp;
+	struct bfq_group *bfqg;
+	struct hlist_node *n;
+
+	if (val > 1)
+		return -EINVAL;
+
+	if (!cgroup_lock_live_group(cgroup))
+		return -ENODEV;
+
+	bgrp = cgroup_to_bfqio(cgroup);
+
+	spin_lock_irq(&bgrp->lock);
+	bgrp->foreground = (unsigned short)val;
+	hlist_for_each_entry(bfqg, n, &bgrp->group_data, group_node)
+		bfqg->foreground = (int)val;
+	spin_unlock_irq(&bgrp->lock);
+
+	cgroup_unlock();
+
+	return 0;
+}
+
+static int bfqio_cgroup_latency_hist_read(struct cgroup *cgroup,
+					  struct cftype *cftype,
+					  struct seq_file *m)
+{
+	unsigned long hist[2][BFQ_LAT_BUCKETS];
+	struct bfqio_cgroup *bgrp;
+	struct bfq_group *bfqg;
+	struct hlist_node *n;
+	int i;
+
+	if (!cgroup_lock_live_group(cgroup))
+		return -ENODEV;
+
+	bgrp = cgroup_to_bfqio(cgroup);
+	memset(hist, 0, sizeof(hist));
+
+	/*
+	 * The counters are updated under the queue locks of the devices,
+	 * which we don't take here: the sums may be slightly stale.
+	 */
+	spin_lock_irq(&bgrp->lock);
+	hlist_for_each_entry(bfqg, n, &bgrp->group_data, group_node) {
+		for (i = 0; i < BFQ_LAT_BUCKETS; i++) {
+			hist[READ][i] += bfqg->lat_hist[READ][i];
+			hist[WRITE][i] += bfqg->lat_hist[WRITE][i];
+		}
+	}
+	spin_unlock_irq(&bgrp->lock);
+
+	cgroup_unlock();
+
+	seq_printf(m, "%-8s %10s %10s\n", "msec", "read", "write");
+	for (i = 0; i < BFQ_LAT_BUCKETS; i++) {
+		if (i < BFQ_LAT_BUCKETS - 1)
+			seq_printf(m, "<%-7u", bfq_lat_bucket_ms[i]);
+		else
+			seq_printf(m, ">=%-6u", bfq_lat_bucket_ms[i - 1]);
+		seq_printf(m, " %10lu %10lu\n", hist[READ][i], hist[WRITE][i]);
+	}
+
+	return 0;
+}
+
 static struct cftype bfqio_files[] = {
 	{
 		.name = "weight",
@@ -602,6 +750,15 @@ static struct cftype bfqio_files[] = {
 		.read_u64 = bfqio_cgroup_ioprio_class_read,
 		.write_u64 = bfqio_cgroup_ioprio_class_write,
 	},
+	{
+		.name = "foreground",
+		.read_u64 = bfqio_cgroup_foreground_read,
+		.write_u64 = bfqio_cgroup_foreground_write,
+	},
+	{
+		.name = "latency_hist",
+		.read_seq_string = bfqio_cgroup_latency_hist_read,
+	},
 };
 
 static int bfqio_populate(struct cgroup_subsys *subsys, struct cgroup *cgroup)
@@ -742,6 +899,16 @@ static inline void bfq_bfqq_move(struct bfq_data *bfqd,
 {
 }
 
+static inline int bfq_bfqq_foreground(struct bfq_queue *bfqq)
+{
+	return 0;
+}
+
+static inline void bfq_account_latency(struct bfq_queue *bfqq,
+				       struct request *rq)
+{
+}
+
 static inline void bfq_disconnect_groups(struct bfq_data *bfqd)
 {
 	bfq_put_async_queues(bfqd, bfqd->root_group);
@@ -56,6 +56,7 @@
 #include <linux/slab.h>
 #include <linux/blkdev.h>
 #include <linux/cgroup.h>
+#include <linux/seq_file.h>
 #include <linux/elevator.h>
 #include <linux/rbtree.h>
 #include <linux/ioprio.h>
@@ -382,11 +383,13 @@ static void bfq_add_rq_rb(struct request *rq)
 
 		/*
 		 * If the queue is not being boosted and has been idle
-		 * for enough time, start a weight-raising period
+		 * for enough time, or belongs to a foreground group,
+		 * start a weight-raising period
 		 */
 		if(old_raising_coeff == 1 &&
+		   (bfq_bfqq_foreground(bfqq) ||
 		    bfqq->last_rais_start_finish +
-		    bfqd->bfq_raising_min_idle_time < jiffies) {
+		    bfqd->bfq_raising_min_idle_time < jiffies)) {
 			bfqq->raising_coeff = bfqd->bfq_raising_coeff;
 			entity->ioprio_changed = 1;
 			bfq_log_bfqq(bfqd, bfqq,
@@ -1190,9 +1193,12 @@ static int __bfq_dispatch_requests(struct bfq_data *bfqd,
 				"WARN: pending prio change");
 			/*
 			 * If too much time has elapsed from the beginning
-			 * of this weight-raising period, stop it
+			 * of this weight-raising period, stop it; queues
+			 * in a foreground group stay raised until they
+			 * leave it
 			 */
-			if (jiffies - bfqq->last_rais_start_finish >
+			if (!bfq_bfqq_foreground(bfqq) &&
+			    jiffies - bfqq->last_rais_start_finish >
 				bfqd->bfq_raising_max_time) {
 				bfqq->raising_coeff = 1;
 				bfqq->last_rais_start_finish = jiffies;
@@ -1778,6 +1784,8 @@ static void bfq_completed_request(struct request_queue *q, struct request *rq)
 	if (sync)
 		RQ_CIC(rq)->last_end_request = jiffies;
 
+	bfq_account_latency(bfqq, rq);
+
 	/*
 	 * If this is the active queue, check if it needs to be expired,
 	 * or if we want to idle in case it has no pending requests.
@@ -26,6 +26,9 @@
 #define BFQ_DEFAULT_GRP_IOPRIO	0
 #define BFQ_DEFAULT_GRP_CLASS	IOPRIO_CLASS_BE
 
+/* Number of buckets of the per-group completion latency histograms. */
+#define BFQ_LAT_BUCKETS		8
+
 struct bfq_entity;
 
 /**
@@ -407,6 +410,10 @@ enum bfqq_expiration {
  * @async_idle_bfqq: async queue for the idle class (ioprio is ignored).
  * @my_entity: pointer to @entity, %NULL for the toplevel group; used
  *             to avoid too many special cases during group creation/migration.
+ * @foreground: copy of the foreground flag of the owning cgroup; queues
+ *              of a foreground group are kept weight-raised.
+ * @lat_hist: histogram of the latencies (from queueing to completion) of
+ *            the requests of the group, one per data direction.
  *
  * Each (device, cgroup) pair has its own bfq_group, i.e., for each cgroup
  * there is a set of bfq_groups, each one collecting the lower-level
@@ -432,6 +439,9 @@ struct bfq_group {
 	struct bfq_queue *async_idle_bfqq;
 
 	struct bfq_entity *my_entity;
+
+	int foreground;
+	unsigned long lat_hist[2][BFQ_LAT_BUCKETS];
 };
 
 /**
@@ -440,6 +450,8 @@ struct bfq_group {
  * @weight: cgroup weight.
  * @ioprio: cgroup ioprio.
  * @ioprio_class: cgroup ioprio_class.
+ * @foreground: if set, the I/O of the tasks in the cgroup gets the
+ *              low_latency weight raising for as long as they stay there.
  * @lock: spinlock that protects @ioprio, @ioprio_class and @group_data.
  * @group_data: list containing the bfq_group belonging to this cgroup.
  *
@@ -449,7 +461,7 @@ struct bfq_group {
 struct bfqio_cgroup {
 	struct cgroup_subsys_state css;
 
-	unsigned short weight, ioprio, ioprio_class;
+	unsigned short weight, ioprio, ioprio_class, foreground;
 
 	spinlock_t lock;
 	struct hlist_head group_data;
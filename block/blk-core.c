@@ -127,6 +127,7 @@ void blk_rq_init(struct request_queue *q, struct request *rq)
 	rq->tag = -1;
 	rq->ref_count = 1;
 	rq->start_time = jiffies;
+	blk_rq_set_queue_time(rq);
 }
 EXPORT_SYMBOL(blk_rq_init);
 
@@ -1743,6 +1744,8 @@ static void blk_account_io_done(struct request *req)
 		part_dec_in_flight(part, rw);
 
 		part_stat_unlock();
+
+		blk_account_latency(req);
 	}
 }
 
@@ -1898,6 +1901,7 @@ void blk_start_request(struct request *req)
 		req->next_rq->resid_len = blk_rq_bytes(req->next_rq);
 
 	blk_add_timer(req);
+	blk_rq_set_io_start_time(req);
 }
 EXPORT_SYMBOL(blk_start_request);
 
@@ -0,0 +1,93 @@
+/*
+ * Per-queue request latency histograms
+ *
+ * Every file system request is timed twice: when it is allocated, and
+ * when the driver starts it.  At completion the time between the two
+ * (queue time, mostly spent in the I/O scheduler) and the time from the
+ * start to the completion (service time) go into log2 histograms, one
+ * per direction, kept in the request_queue.
+ */
+#include <linux/kernel.h>
+#include <linux/blkdev.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+
+#include <trace/events/block.h>
+
+#include "blk.h"
+
+static inline int blk_lat_bucket(u64 ns)
+{
+	unsigned long us = div_u64(ns, NSEC_PER_USEC);
+
+	return min_t(int, fls_long(us), BLK_LAT_BUCKETS - 1);
+}
+
+/*
+ * Called with the queue lock held when a request that counts in the
+ * disk statistics completes.
+ */
+void blk_account_latency(struct request *rq)
+{
+	struct blk_latency_hist *hist = &rq->q->lat_hist;
+	const int rw = rq_data_dir(rq);
+	u64 now = ktime_to_ns(ktime_get());
+	u64 queue_ns = 0, service_ns;
+
+	/*
+	 * A request completed without going through blk_start_request()
+	 * has no start time, and all of its latency counts as service.
+	 * Nothing was saved for the trace event either, so it is not
+	 * traced.
+	 */
+	if (rq->io_start_time_ns >= rq->queue_time_ns) {
+		queue_ns = rq->io_start_time_ns - rq->queue_time_ns;
+		hist->queue[rw][blk_lat_bucket(queue_ns)]++;
+		service_ns = now - rq->io_start_time_ns;
+		trace_block_rq_latency(rq->q, rq, queue_ns, service_ns);
+	} else
+		service_ns = now - rq->queue_time_ns;
+	hist->service[rw][blk_lat_bucket(service_ns)]++;
+}
+
+ssize_t queue_latency_hist_show(struct request_queue *q, char *page)
+{
+	struct blk_latency_hist *hist;
+	ssize_t len;
+	int i;
+
+	hist = kmalloc(sizeof(*hist), GFP_KERNEL);
+	if (!hist)
+		return -ENOMEM;
+
+	spin_lock_irq(q->queue_lock);
+	memcpy(hist, &q->lat_hist, sizeof(*hist));
+	spin_unlock_irq(q->queue_lock);
+
+	len = sprintf(page, "%10s %10s %10s %10s %10s\n", "us",
+		      "read_q", "read_svc", "write_q", "write_svc");
+	for (i = 0; i < BLK_LAT_BUCKETS; i++) {
+		if (i < BLK_LAT_BUCKETS - 1)
+			len += sprintf(page + len, "<%9lu", 1UL << i);
+		else
+			len += sprintf(page + len, ">=%8lu", 1UL << (i - 1));
+		len += sprintf(page + len, " %10lu %10lu %10lu %10lu\n",
+			       hist->queue[READ][i], hist->service[READ][i],
+			       hist->queue[WRITE][i], hist->service[WRITE][i]);
+	}
+
+	kfree(hist);
+	return len;
+}
+
+/* Any write clears the histograms. */
+ssize_t queue_latency_hist_store(struct request_queue *q, const char *page,
+				 size_t count)
+{
+	spin_lock_irq(q->queue_lock);
+	memset(&q->lat_hist, 0, sizeof(q->lat_hist));
+	spin_unlock_irq(q->queue_lock);
+
+	return count;
+}
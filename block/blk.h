@@ -165,4 +165,42 @@ static inline int blk_do_io_stat(struct request *rq)
 	       (blk_fs_request(rq) || blk_discard_rq(rq));
 }
 
+#ifdef CONFIG_BLK_IO_LATENCY
+void blk_account_latency(struct request *rq);
+ssize_t queue_latency_hist_show(struct request_queue *q, char *page);
+ssize_t queue_latency_hist_store(struct request_queue *q, const char *page,
+				 size_t count);
+
+static inline void blk_rq_set_queue_time(struct request *rq)
+{
+	rq->queue_time_ns = ktime_to_ns(ktime_get());
+}
+
+/*
+ * By completion the request has been used up by blk_update_request(),
+ * so note where it started and how long it was for the trace event.
+ */
+static inline void blk_rq_set_io_start_time(struct request *rq)
+{
+	rq->io_start_time_ns = ktime_to_ns(ktime_get());
+	rq->io_start_sector = blk_rq_pos(rq);
+	rq->io_start_nr_sectors = blk_rq_sectors(rq);
+	rq->io_start_cmd_flags = rq->cmd_flags;
+}
+
+/* a merged request was queued when the older of the two was */
+static inline void blk_rq_merge_queue_time(struct request *rq,
+					   struct request *next)
+{
+	if (next->queue_time_ns < rq->queue_time_ns)
+		rq->queue_time_ns = next->queue_time_ns;
+}
+#else
+static inline void blk_account_latency(struct request *rq) { }
+static inline void blk_rq_set_queue_time(struct request *rq) { }
+static inline void blk_rq_set_io_start_time(struct request *rq) { }
+static inline void blk_rq_merge_queue_time(struct request *rq,
+					   struct request *next) { }
+#endif
+
 #endif
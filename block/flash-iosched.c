@@ -0,0 +1,482 @@
+/*
+ *  Flash i/o scheduler.
+ *
+ *  Based on the deadline i/o scheduler,
+ *  Copyright (C) 2002 Jens Axboe <axboe@kernel.dk>
+ *
+ *  An elevator for non-rotational devices such as eMMC and SD cards.
+ *  There is no seek penalty to avoid and nothing to gain from idling,
+ *  so the only concerns are keeping synchronous requests (reads, and
+ *  writes someone is waiting for) fast while a stream of background
+ *  writes is going on, and handing those writes to the device in an
+ *  order its translation layer handles well.
+ *
+ *  Sync requests are served in FIFO order. Async writes are sorted and
+ *  dispatched in batches which stay within one erase block sized
+ *  region. When both are pending, sync_ratio sync requests are
+ *  dispatched for every batch of up to write_batch writes, unless the
+ *  oldest write has waited longer than write_expire.
+ *
+ *  See Documentation/block/flash-iosched.txt
+ */
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/blkdev.h>
+#include <linux/elevator.h>
+#include <linux/bio.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/init.h>
+#include <linux/compiler.h>
+#include <linux/rbtree.h>
+#include <linux/log2.h>
+
+static const int write_expire = HZ;	/* max time before a write is submitted */
+static const int sync_ratio = 16;	/* sync requests per write batch */
+static const int write_batch = 8;	/* max writes in one batch */
+static const int erase_block_kb = 512;	/* size of a write batch region */
+
+enum {
+	FLASH_SYNC = 0,
+	FLASH_ASYNC,
+};
+
+struct flash_data {
+	/*
+	 * run time data
+	 */
+
+	/*
+	 * requests are present on both sort_list and fifo_list
+	 */
+	struct rb_root sort_list[2];
+	struct list_head fifo_list[2];
+
+	struct request *next_write;	/* next in the current write batch */
+	unsigned int write_batching;	/* writes dispatched in this batch */
+	unsigned int sync_dispatched;	/* sync requests since last batch */
+	unsigned int region_shift;	/* log2 of erase block in sectors */
+
+	/*
+	 * settings that change how the i/o scheduler behaves
+	 */
+	int write_expire;
+	int sync_ratio;
+	int write_batch;
+	int erase_block_kb;
+	int front_merges;
+};
+
+static void flash_move_to_dispatch(struct flash_data *, struct request *);
+
+static inline int flash_rq_queue(struct request *rq)
+{
+	return rq_is_sync(rq) ? FLASH_SYNC : FLASH_ASYNC;
+}
+
+static inline int flash_bio_queue(struct bio *bio)
+{
+	return (bio_data_dir(bio) == READ ||
+		bio_rw_flagged(bio, BIO_RW_SYNCIO)) ? FLASH_SYNC : FLASH_ASYNC;
+}
+
+static inline struct rb_root *
+flash_rb_root(struct flash_data *fd, struct request *rq)
+{
+	return &fd->sort_list[flash_rq_queue(rq)];
+}
+
+static inline sector_t flash_region(struct flash_data *fd, struct request *rq)
+{
+	return blk_rq_pos(rq) >> fd->region_shift;
+}
+
+/*
+ * get the write after `rq' in sector-sorted order, if it is in the same
+ * erase block region
+ */
+static struct request *
+flash_next_in_region(struct flash_data *fd, struct request *rq)
+{
+	struct rb_node *node = rb_next(&rq->rb_node);
+	struct request *next;
+
+	if (!node)
+		return NULL;
+
+	next = rb_entry_rq(node);
+	if (flash_region(fd, next) != flash_region(fd, rq))
+		return NULL;
+
+	return next;
+}
+
+/*
+ * get the lowest-sectored write in the same erase block region as `rq'
+ */
+static struct request *
+flash_first_in_region(struct flash_data *fd, struct request *rq)
+{
+	struct rb_node *node;
+	struct request *prev;
+
+	while ((node = rb_prev(&rq->rb_node)) != NULL) {
+		prev = rb_entry_rq(node);
+		if (flash_region(fd, prev) != flash_region(fd, rq))
+			break;
+		rq = prev;
+	}
+
+	return rq;
+}
+
+static void
+flash_add_rq_rb(struct flash_data *fd, struct request *rq)
+{
+	struct rb_root *root = flash_rb_root(fd, rq);
+	struct request *__alias;
+
+	while (unlikely(__alias = elv_rb_add(root, rq)))
+		flash_move_to_dispatch(fd, __alias);
+}
+
+static inline void
+flash_del_rq_rb(struct flash_data *fd, struct request *rq)
+{
+	if (fd->next_write == rq)
+		fd->next_write = flash_next_in_region(fd, rq);
+
+	elv_rb_del(flash_rb_root(fd, rq), rq);
+}
+
+/*
+ * add rq to rbtree and fifo
+ */
+static void
+flash_add_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int queue = flash_rq_queue(rq);
+
+	flash_add_rq_rb(fd, rq);
+
+	/*
+	 * sync requests are served in arrival order, only writes expire
+	 */
+	rq_set_fifo_time(rq, jiffies + fd->write_expire);
+	list_add_tail(&rq->queuelist, &fd->fifo_list[queue]);
+}
+
+/*
+ * remove rq from rbtree and fifo.
+ */
+static void flash_remove_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	rq_fifo_clear(rq);
+	flash_del_rq_rb(fd, rq);
+}
+
+static int
+flash_merge(struct request_queue *q, struct request **req, struct bio *bio)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	struct request *__rq;
+
+	/*
+	 * check for front merge
+	 */
+	if (fd->front_merges) {
+		sector_t sector = bio->bi_sector + bio_sectors(bio);
+
+		__rq = elv_rb_find(&fd->sort_list[flash_bio_queue(bio)], sector);
+		if (__rq) {
+			BUG_ON(sector != blk_rq_pos(__rq));
+
+			if (elv_rq_merge_ok(__rq, bio)) {
+				*req = __rq;
+				return ELEVATOR_FRONT_MERGE;
+			}
+		}
+	}
+
+	return ELEVATOR_NO_MERGE;
+}
+
+static void flash_merged_request(struct request_queue *q,
+				 struct request *req, int type)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	/*
+	 * if the merge was a front merge, we need to reposition request
+	 */
+	if (type == ELEVATOR_FRONT_MERGE) {
+		elv_rb_del(flash_rb_root(fd, req), req);
+		flash_add_rq_rb(fd, req);
+	}
+}
+
+static void
+flash_merged_requests(struct request_queue *q, struct request *req,
+		      struct request *next)
+{
+	/*
+	 * if next expires before rq, assign its expire time to rq
+	 * and move into next position (next will be deleted) in fifo
+	 */
+	if (!list_empty(&req->queuelist) && !list_empty(&next->queuelist)) {
+		if (time_before(rq_fifo_time(next), rq_fifo_time(req))) {
+			list_move(&req->queuelist, &next->queuelist);
+			rq_set_fifo_time(req, rq_fifo_time(next));
+		}
+	}
+
+	/*
+	 * kill knowledge of next, this one is a goner
+	 */
+	flash_remove_request(q, next);
+}
+
+/*
+ * move request from sort list to dispatch queue.
+ */
+static void
+flash_move_to_dispatch(struct flash_data *fd, struct request *rq)
+{
+	struct request_queue *q = rq->q;
+
+	flash_remove_request(q, rq);
+	elv_dispatch_add_tail(q, rq);
+}
+
+/*
+ * returns 1 if the oldest queued write has passed its deadline.
+ * Requires !list_empty(&fd->fifo_list[FLASH_ASYNC])
+ */
+static inline int flash_write_expired(struct flash_data *fd)
+{
+	struct request *rq = rq_entry_fifo(fd->fifo_list[FLASH_ASYNC].next);
+
+	return time_after(jiffies, rq_fifo_time(rq));
+}
+
+/*
+ * flash_dispatch_requests selects the next request to send to the
+ * device. It never idles: if anything is queued, something is
+ * dispatched.
+ */
+static int flash_dispatch_requests(struct request_queue *q, int force)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int syncs = !list_empty(&fd->fifo_list[FLASH_SYNC]);
+	const int writes = !list_empty(&fd->fifo_list[FLASH_ASYNC]);
+	struct request *rq;
+
+	/*
+	 * carry on with the current write batch while it lasts
+	 */
+	if (fd->next_write && fd->write_batching < fd->write_batch) {
+		rq = fd->next_write;
+		goto dispatch_write;
+	}
+
+	if (syncs) {
+		if (writes && (fd->sync_dispatched >= fd->sync_ratio ||
+			       flash_write_expired(fd)))
+			goto start_write_batch;
+
+		rq = rq_entry_fifo(fd->fifo_list[FLASH_SYNC].next);
+		fd->sync_dispatched++;
+		fd->next_write = NULL;
+		flash_move_to_dispatch(fd, rq);
+		return 1;
+	}
+
+	if (!writes)
+		return 0;
+
+start_write_batch:
+	/*
+	 * start with the region holding the oldest write, from the lowest
+	 * sector queued in it
+	 */
+	rq = rq_entry_fifo(fd->fifo_list[FLASH_ASYNC].next);
+	rq = flash_first_in_region(fd, rq);
+	fd->write_batching = 0;
+	fd->sync_dispatched = 0;
+
+dispatch_write:
+	fd->write_batching++;
+	fd->next_write = flash_next_in_region(fd, rq);
+	flash_move_to_dispatch(fd, rq);
+	return 1;
+}
+
+static int flash_queue_empty(struct request_queue *q)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	return list_empty(&fd->fifo_list[FLASH_SYNC])
+		&& list_empty(&fd->fifo_list[FLASH_ASYNC]);
+}
+
+static void flash_exit_queue(struct elevator_queue *e)
+{
+	struct flash_data *fd = e->elevator_data;
+
+	BUG_ON(!list_empty(&fd->fifo_list[FLASH_SYNC]));
+	BUG_ON(!list_empty(&fd->fifo_list[FLASH_ASYNC]));
+
+	kfree(fd);
+}
+
+static void flash_set_erase_block(struct flash_data *fd, int kb)
+{
+	fd->erase_block_kb = rounddown_pow_of_two(kb);
+	fd->region_shift = ilog2(fd->erase_block_kb) + 1;
+}
+
+/*
+ * initialize elevator private data (flash_data).
+ */
+static void *flash_init_queue(struct request_queue *q)
+{
+	struct flash_data *fd;
+
+	fd = kmalloc_node(sizeof(*fd), GFP_KERNEL | __GFP_ZERO, q->node);
+	if (!fd)
+		return NULL;
+
+	INIT_LIST_HEAD(&fd->fifo_list[FLASH_SYNC]);
+	INIT_LIST_HEAD(&fd->fifo_list[FLASH_ASYNC]);
+	fd->sort_list[FLASH_SYNC] = RB_ROOT;
+	fd->sort_list[FLASH_ASYNC] = RB_ROOT;
+	fd->write_expire = write_expire;
+	fd->sync_ratio = sync_ratio;
+	fd->write_batch = write_batch;
+	fd->front_merges = 1;
+	flash_set_erase_block(fd, erase_block_kb);
+	return fd;
+}
+
+/*
+ * sysfs parts below
+ */
+
+static ssize_t
+flash_var_show(int var, char *page)
+{
+	return sprintf(page, "%d\n", var);
+}
+
+static ssize_t
+flash_var_store(int *var, const char *page, size_t count)
+{
+	char *p = (char *) page;
+
+	*var = simple_strtol(p, &p, 10);
+	return count;
+}
+
+#define SHOW_FUNCTION(__FUNC, __VAR, __CONV)				\
+static ssize_t __FUNC(struct elevator_queue *e, char *page)		\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data = __VAR;						\
+	if (__CONV)							\
+		__data = jiffies_to_msecs(__data);			\
+	return flash_var_show(__data, (page));				\
+}
+SHOW_FUNCTION(flash_write_expire_show, fd->write_expire, 1);
+SHOW_FUNCTION(flash_sync_ratio_show, fd->sync_ratio, 0);
+SHOW_FUNCTION(flash_write_batch_show, fd->write_batch, 0);
+SHOW_FUNCTION(flash_erase_block_kb_show, fd->erase_block_kb, 0);
+SHOW_FUNCTION(flash_front_merges_show, fd->front_merges, 0);
+#undef SHOW_FUNCTION
+
+#define STORE_FUNCTION(__FUNC, __PTR, MIN, MAX, __CONV)			\
+static ssize_t __FUNC(struct elevator_queue *e, const char *page, size_t count)	\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data;							\
+	int ret = flash_var_store(&__data, (page), count);		\
+	if (__data < (MIN))						\
+		__data = (MIN);						\
+	else if (__data > (MAX))					\
+		__data = (MAX);						\
+	if (__CONV)							\
+		*(__PTR) = msecs_to_jiffies(__data);			\
+	else								\
+		*(__PTR) = __data;					\
+	return ret;							\
+}
+STORE_FUNCTION(flash_write_expire_store, &fd->write_expire, 0, INT_MAX, 1);
+STORE_FUNCTION(flash_sync_ratio_store, &fd->sync_ratio, 0, INT_MAX, 0);
+STORE_FUNCTION(flash_write_batch_store, &fd->write_batch, 1, INT_MAX, 0);
+STORE_FUNCTION(flash_front_merges_store, &fd->front_merges, 0, 1, 0);
+#undef STORE_FUNCTION
+
+static ssize_t
+flash_erase_block_kb_store(struct elevator_queue *e, const char *page,
+			   size_t count)
+{
+	struct flash_data *fd = e->elevator_data;
+	int __data;
+	int ret = flash_var_store(&__data, (page), count);
+
+	/* 4KB to 64MB */
+	flash_set_erase_block(fd, clamp(__data, 4, 65536));
+	return ret;
+}
+
+#define FD_ATTR(name) \
+	__ATTR(name, S_IRUGO|S_IWUSR, flash_##name##_show, \
+				      flash_##name##_store)
+
+static struct elv_fs_entry flash_attrs[] = {
+	FD_ATTR(write_expire),
+	FD_ATTR(sync_ratio),
+	FD_ATTR(write_batch),
+	FD_ATTR(erase_block_kb),
+	FD_ATTR(front_merges),
+	__ATTR_NULL
+};
+
+static struct elevator_type iosched_flash = {
+	.ops = {
+		.elevator_merge_fn = 		flash_merge,
+		.elevator_merged_fn =		flash_merged_request,
+		.elevator_merge_req_fn =	flash_merged_requests,
+		.elevator_dispatch_fn =		flash_dispatch_requests,
+		.elevator_add_req_fn =		flash_add_request,
+		.elevator_queue_empty_fn =	flash_queue_empty,
+		.elevator_former_req_fn =	elv_rb_former_request,
+		.elevator_latter_req_fn =	elv_rb_latter_request,
+		.elevator_init_fn =		flash_init_queue,
+		.elevator_exit_fn =		flash_exit_queue,
+	},
+
+	.elevator_attrs = flash_attrs,
+	.elevator_name = "flash",
+	.elevator_owner = THIS_MODULE,
+};
+
+static int __init flash_init(void)
+{
+	elv_register(&iosched_flash);
+
+	return 0;
+}
+
+static void __exit flash_exit(void)
+{
+	elv_unregister(&iosched_flash);
+}
+
+module_init(flash_init);
+module_exit(flash_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Flash IO scheduler");
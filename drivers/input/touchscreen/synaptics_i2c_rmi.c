@@ -782,7 +782,7 @@ static void __exit synaptics_ts_exit(void)
 		destroy_workqueue(synaptics_wq);
 }
 
-module_init(synaptics_ts_init);
+device_initcall_async(synaptics_ts_init);
 module_exit(synaptics_ts_exit);
 
 MODULE_DESCRIPTION("Synaptics Touchscreen Driver");
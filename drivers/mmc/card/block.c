@@ -28,6 +28,7 @@
 #include <linux/kdev_t.h>
 #include <linux/blkdev.h>
 #include <linux/mutex.h>
+#include <linux/completion.h>
 #include <linux/scatterlist.h>
 #include <linux/string_helpers.h>
 
@@ -64,8 +65,18 @@ struct mmc_blk_data {
 
 	unsigned int	usage;
 	unsigned int	read_only;
+
+	/* eMMC packed writes, see mmc_blk_issue_packed() */
+	unsigned int	packed_enable;
+	u32		*packed_hdr;
+	unsigned long	packed_cmds;	/* packed commands issued */
+	unsigned long	packed_reqs;	/* requests sent packed */
+	unsigned long	packed_fails;	/* packed commands retried unpacked */
 };
 
+/* Upper bound on requests per packed command */
+#define MMC_BLK_MAX_PACKED	16
+
 static DEFINE_MUTEX(open_lock);
 
 static struct mmc_blk_data *mmc_blk_get(struct gendisk *disk)
@@ -99,6 +110,7 @@ static void mmc_blk_put(struct mmc_blk_data *md)
 		__clear_bit(devidx, dev_use);
 
 		put_disk(md->disk);
+		kfree(md->packed_hdr);
 		kfree(md);
 	}
 	mutex_unlock(&open_lock);
@@ -272,21 +284,15 @@ mmc_blk_set_blksize(struct mmc_blk_data *md, struct mmc_card *card)
 }
 
 
-static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
+static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *req)
 {
 	struct mmc_blk_data *md = mq->data;
 	struct mmc_card *card = md->queue.card;
 	struct mmc_blk_request brq;
+	DECLARE_COMPLETION_ONSTACK(complete);
 	int ret = 1, disable_multi = 0;
 	int sd_in_programm_state = 0;
 
-#ifdef CONFIG_MMC_BLOCK_DEFERRED_RESUME
-	if (mmc_bus_needs_resume(card->host)) {
-		mmc_resume_bus(card->host);
-		mmc_blk_set_blksize(md, card);
-	}
-#endif
-
 	mmc_claim_host(card->host);
 
 	do {
@@ -348,32 +354,49 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 
 		mmc_set_data_timeout(&brq.data, card);
 
-		brq.data.sg = mq->sg;
-		brq.data.sg_len = mmc_queue_map_sg(mq);
-
 		/*
-		 * Adjust the sg list so it is the same size as the
-		 * request.
+		 * The request may already have been mapped, and handed to
+		 * the host's pre_req hook, while the previous one was
+		 * being transferred.
 		 */
-		if (brq.data.blocks != blk_rq_sectors(req)) {
-			int i, data_size = brq.data.blocks << 9;
-			struct scatterlist *sg;
-
-			for_each_sg(brq.data.sg, sg, brq.data.sg_len, i) {
-				data_size -= sg->length;
-				if (data_size <= 0) {
-					sg->length += data_size;
-					i++;
-					break;
+		if (!mmc_queue_use_prep(mq, &brq.data)) {
+			brq.data.sg = mq->sg;
+			brq.data.sg_len = mmc_queue_map_sg(mq);
+
+			/*
+			 * Adjust the sg list so it is the same size as the
+			 * request.
+			 */
+			if (brq.data.blocks != blk_rq_sectors(req)) {
+				int i, data_size = brq.data.blocks << 9;
+				struct scatterlist *sg;
+
+				for_each_sg(brq.data.sg, sg, brq.data.sg_len,
+						i) {
+					data_size -= sg->length;
+					if (data_size <= 0) {
+						sg->length += data_size;
+						i++;
+						break;
+					}
 				}
+				brq.data.sg_len = i;
 			}
-			brq.data.sg_len = i;
+
+			mmc_queue_bounce_pre(mq);
+			mmc_pre_req(card->host, &brq.mrq, true);
 		}
 
-		mmc_queue_bounce_pre(mq);
+		INIT_COMPLETION(complete);
+		mmc_start_req(card->host, &brq.mrq, &complete);
 
-		mmc_wait_for_req(card->host, &brq.mrq);
+		/* Prepare the next request while this one transfers */
+		mmc_queue_prep_next(mq);
+
+		wait_for_completion(&complete);
 
+		mmc_post_req(card->host, &brq.mrq,
+			brq.cmd.error || brq.data.error || brq.stop.error);
 		mmc_queue_bounce_post(mq);
 
 		/*
@@ -539,6 +562,250 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 }
 
 
+/*
+ * Wait for the card to leave the programming state after a write.
+ */
+static int mmc_blk_wait_prg_done(struct mmc_card *card)
+{
+	struct mmc_command cmd;
+	unsigned long timeout = jiffies + 10 * HZ;
+	int err;
+
+	do {
+		memset(&cmd, 0, sizeof(struct mmc_command));
+		cmd.opcode = MMC_SEND_STATUS;
+		cmd.arg = card->rca << 16;
+		cmd.flags = MMC_RSP_R1 | MMC_CMD_AC;
+		err = mmc_wait_for_cmd(card->host, &cmd, 5);
+		if (err)
+			return err;
+		if (time_after(jiffies, timeout))
+			return -ETIMEDOUT;
+	} while (!(cmd.resp[0] & R1_READY_FOR_DATA) ||
+		(R1_CURRENT_STATE(cmd.resp[0]) == 7));
+
+	return 0;
+}
+
+static inline int mmc_blk_packed_capable(struct mmc_blk_data *md,
+	struct mmc_card *card)
+{
+	return md->packed_enable && md->packed_hdr && !md->queue.bounce_buf &&
+		mmc_card_mmc(card) && !mmc_host_is_spi(card->host) &&
+		card->ext_csd.max_packed_writes > 1;
+}
+
+/*
+ * Take further write requests off the queue for as long as they fit in
+ * one packed command together with req. Returns the number of requests
+ * in reqs[], including req itself.
+ */
+static int mmc_blk_collect_packed(struct mmc_queue *mq, struct request *req,
+	struct request **reqs, unsigned int *blocks, unsigned int *segs)
+{
+	struct mmc_card *card = mq->card;
+	struct mmc_host *host = card->host;
+	struct request_queue *q = mq->queue;
+	unsigned int max_reqs, max_blocks;
+	struct request *next;
+	int n = 1;
+
+	max_reqs = min_t(unsigned int, card->ext_csd.max_packed_writes,
+		MMC_BLK_MAX_PACKED);
+	max_blocks = min(host->max_blk_count, host->max_req_size / 512);
+
+	reqs[0] = req;
+	*blocks = 1 + blk_rq_sectors(req);	/* header plus data */
+	*segs = 1 + req->nr_phys_segments;
+	if (blk_barrier_rq(req) || *blocks > max_blocks ||
+	    *segs > host->max_phys_segs)
+		return 1;
+
+	spin_lock_irq(q->queue_lock);
+	while (n < max_reqs) {
+		next = blk_peek_request(q);
+		if (!next || !blk_fs_request(next) || blk_barrier_rq(next) ||
+		    rq_data_dir(next) != WRITE)
+			break;
+		if (*blocks + blk_rq_sectors(next) > max_blocks ||
+		    *segs + next->nr_phys_segments > host->max_phys_segs)
+			break;
+
+		blk_start_request(next);
+		*blocks += blk_rq_sectors(next);
+		*segs += next->nr_phys_segments;
+		reqs[n++] = next;
+	}
+	spin_unlock_irq(q->queue_lock);
+
+	return n;
+}
+
+/*
+ * eMMC 4.5 packed write: several write requests are sent as a single
+ * CMD23 + CMD25 transfer. The first block of data is a header listing
+ * the address and length of each request; the requests' data follows
+ * back to back.
+ *
+ * Returns 0 if req should be issued normally, 1 if it was handled here.
+ */
+static int mmc_blk_issue_packed(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+	struct request *reqs[MMC_BLK_MAX_PACKED];
+	struct mmc_blk_request brq;
+	struct mmc_command sbc;
+	struct scatterlist *sg;
+	unsigned int blocks, segs, sg_len;
+	u32 *hdr = md->packed_hdr;
+	int i, n, err;
+
+	n = mmc_blk_collect_packed(mq, req, reqs, &blocks, &segs);
+	if (n < 2)
+		return 0;
+
+	/* The prepared request, if any, may have been packed as well */
+	mmc_queue_cancel_prep(mq);
+
+	memset(hdr, 0, 512);
+	hdr[0] = cpu_to_le32((n << 16) | (MMC_PACKED_CMD_WR << 8) |
+		MMC_PACKED_CMD_VER);
+
+	sg_init_table(mq->sg, card->host->max_phys_segs);
+	sg_set_buf(&mq->sg[0], hdr, 512);
+	sg_len = 1;
+	for (i = 0; i < n; i++) {
+		hdr[(i + 1) * 2] = cpu_to_le32(blk_rq_sectors(reqs[i]));
+		hdr[(i + 1) * 2 + 1] = cpu_to_le32(mmc_card_blockaddr(card) ?
+			blk_rq_pos(reqs[i]) : blk_rq_pos(reqs[i]) << 9);
+
+		sg = &mq->sg[sg_len];
+		sg_len += blk_rq_map_sg(mq->queue, reqs[i], sg);
+		/* blk_rq_map_sg() ended the list; keep going after it */
+		sg_unmark_end(&mq->sg[sg_len - 1]);
+	}
+	sg_mark_end(&mq->sg[sg_len - 1]);
+
+	memset(&brq, 0, sizeof(struct mmc_blk_request));
+	brq.mrq.cmd = &brq.cmd;
+	brq.mrq.data = &brq.data;
+	brq.cmd.opcode = MMC_WRITE_MULTIPLE_BLOCK;
+	brq.cmd.arg = blk_rq_pos(req);
+	if (!mmc_card_blockaddr(card))
+		brq.cmd.arg <<= 9;
+	brq.cmd.flags = MMC_RSP_SPI_R1 | MMC_RSP_R1 | MMC_CMD_ADTC;
+	brq.data.blksz = 512;
+	brq.data.blocks = blocks;
+	brq.data.flags = MMC_DATA_WRITE;
+	brq.data.sg = mq->sg;
+	brq.data.sg_len = sg_len;
+	mmc_set_data_timeout(&brq.data, card);
+
+	memset(&sbc, 0, sizeof(struct mmc_command));
+	sbc.opcode = MMC_SET_BLOCK_COUNT;
+	sbc.arg = MMC_CMD23_ARG_PACKED | blocks;
+	sbc.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	mmc_claim_host(card->host);
+
+	err = mmc_wait_for_cmd(card->host, &sbc, 0);
+	if (!err) {
+		/* The block count is predefined, so no STOP is needed */
+		mmc_pre_req(card->host, &brq.mrq, true);
+		mmc_wait_for_req(card->host, &brq.mrq);
+		mmc_post_req(card->host, &brq.mrq, brq.cmd.error ||
+			brq.data.error);
+		err = brq.cmd.error ? brq.cmd.error : brq.data.error;
+		if (!err)
+			err = mmc_blk_wait_prg_done(card);
+	}
+
+	mmc_release_host(card->host);
+
+	if (!err) {
+		spin_lock_irq(&md->lock);
+		for (i = 0; i < n; i++)
+			__blk_end_request_all(reqs[i], 0);
+		spin_unlock_irq(&md->lock);
+
+		md->packed_cmds++;
+		md->packed_reqs += n;
+		return 1;
+	}
+
+	/*
+	 * We can't tell which of the requests made it to the card, so
+	 * write all of them again one at a time.
+	 */
+	printk(KERN_WARNING "%s: packed write of %d requests failed (%d), "
+	       "retrying unpacked\n", req->rq_disk->disk_name, n, err);
+	md->packed_fails++;
+
+	for (i = 0; i < n; i++) {
+		mq->req = reqs[i];
+		mmc_blk_issue_rw_rq(mq, reqs[i]);
+	}
+	mq->req = req;
+
+	return 1;
+}
+
+static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_blk_data *md = mq->data;
+	struct mmc_card *card = md->queue.card;
+
+#ifdef CONFIG_MMC_BLOCK_DEFERRED_RESUME
+	if (mmc_bus_needs_resume(card->host)) {
+		mmc_resume_bus(card->host);
+		mmc_blk_set_blksize(md, card);
+	}
+#endif
+
+	if (rq_data_dir(req) == WRITE && mmc_blk_packed_capable(md, card) &&
+	    mmc_blk_issue_packed(mq, req))
+		return 1;
+
+	return mmc_blk_issue_rw_rq(mq, req);
+}
+
+static ssize_t packed_write_show(struct device *dev,
+	struct device_attribute *attr, char *buf)
+{
+	struct mmc_blk_data *md = dev_to_disk(dev)->private_data;
+
+	return sprintf(buf, "%u\n", md->packed_enable);
+}
+
+static ssize_t packed_write_store(struct device *dev,
+	struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct mmc_blk_data *md = dev_to_disk(dev)->private_data;
+	unsigned long enable;
+
+	if (strict_strtoul(buf, 10, &enable))
+		return -EINVAL;
+
+	md->packed_enable = !!enable;
+	return count;
+}
+
+static ssize_t packed_stats_show(struct device *dev,
+	struct device_attribute *attr, char *buf)
+{
+	struct mmc_blk_data *md = dev_to_disk(dev)->private_data;
+
+	return sprintf(buf, "max_packed_writes: %u\n"
+		"packed_cmds: %lu\npacked_reqs: %lu\npacked_fails: %lu\n",
+		md->queue.card ? md->queue.card->ext_csd.max_packed_writes : 0,
+		md->packed_cmds, md->packed_reqs, md->packed_fails);
+}
+
+static DEVICE_ATTR(packed_write, S_IRUGO | S_IWUSR, packed_write_show,
+	packed_write_store);
+static DEVICE_ATTR(packed_stats, S_IRUGO, packed_stats_show, NULL);
+
 static inline int mmc_blk_readonly(struct mmc_card *card)
 {
 	return mmc_card_readonly(card) ||
@@ -584,6 +851,11 @@ static struct mmc_blk_data *mmc_blk_alloc(struct mmc_card *card)
 	md->queue.issue_fn = mmc_blk_issue_rq;
 	md->queue.data = md;
 
+	if (mmc_card_mmc(card) && card->ext_csd.max_packed_writes > 1) {
+		md->packed_hdr = kmalloc(512, GFP_KERNEL);
+		md->packed_enable = md->packed_hdr != NULL;
+	}
+
 	md->disk->major	= MMC_BLOCK_MAJOR;
 	md->disk->first_minor = devidx << MMC_SHIFT;
 	md->disk->fops = &mmc_bdops;
@@ -663,6 +935,15 @@ static int mmc_blk_probe(struct mmc_card *card)
 	mmc_set_bus_resume_policy(card->host, 1);
 #endif
 	add_disk(md->disk);
+
+	if (md->packed_hdr) {
+		if (device_create_file(disk_to_dev(md->disk),
+				&dev_attr_packed_write) ||
+		    device_create_file(disk_to_dev(md->disk),
+				&dev_attr_packed_stats))
+			printk(KERN_WARNING "%s: failed to create packed "
+			       "write attributes\n", md->disk->disk_name);
+	}
 	return 0;
 
  out:
@@ -683,6 +964,12 @@ static void mmc_blk_remove(struct mmc_card *card)
 		queue_flag_set_unlocked(QUEUE_FLAG_DEAD,
 					md->queue.queue);
 		remove_all_req(&md->queue);
+		if (md->packed_hdr) {
+			device_remove_file(disk_to_dev(md->disk),
+				&dev_attr_packed_write);
+			device_remove_file(disk_to_dev(md->disk),
+				&dev_attr_packed_stats);
+		}
 		del_gendisk(md->disk);
 
 		/* Then flush out any already in there */
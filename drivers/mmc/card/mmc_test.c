@@ -15,6 +15,7 @@
 #include <linux/mmc/mmc.h>
 
 #include <linux/scatterlist.h>
+#include <linux/completion.h>
 
 #define RESULT_OK		0
 #define RESULT_FAIL		1
@@ -803,6 +804,85 @@ static int mmc_test_multi_xfersize_read(struct mmc_test_card *test)
 	return 0;
 }
 
+/*
+ * Two back to back multi-block reads, the second one prepared with
+ * mmc_pre_req() while the first is still in progress, the way the
+ * block driver issues requests.
+ */
+static int mmc_test_multi_read_pre_req(struct mmc_test_card *test)
+{
+	struct mmc_host *host = test->card->host;
+	struct mmc_request mrq[2];
+	struct mmc_command cmd[2];
+	struct mmc_command stop[2];
+	struct mmc_data data[2];
+	struct scatterlist sg[2];
+	struct completion complete;
+	unsigned int size;
+	int ret, i;
+
+	if (host->max_blk_count == 1)
+		return RESULT_UNSUP_HOST;
+
+	size = PAGE_SIZE;
+	size = min(size, host->max_req_size);
+	size = min(size, host->max_seg_size);
+	size = min(size, host->max_blk_count * 512);
+
+	if (size < 1024)
+		return RESULT_UNSUP_HOST;
+
+	ret = mmc_test_set_blksize(test, 512);
+	if (ret)
+		return ret;
+
+	memset(test->buffer, 0, size * 2);
+
+	for (i = 0;i < 2;i++) {
+		memset(&mrq[i], 0, sizeof(struct mmc_request));
+		memset(&cmd[i], 0, sizeof(struct mmc_command));
+		memset(&data[i], 0, sizeof(struct mmc_data));
+		memset(&stop[i], 0, sizeof(struct mmc_command));
+
+		mrq[i].cmd = &cmd[i];
+		mrq[i].data = &data[i];
+		mrq[i].stop = &stop[i];
+
+		sg_init_one(&sg[i], test->buffer + i * size, size);
+		mmc_test_prepare_mrq(test, &mrq[i], &sg[i], 1, i * size,
+			size / 512, 512, 0);
+	}
+
+	mmc_pre_req(host, &mrq[0], true);
+	init_completion(&complete);
+	mmc_start_req(host, &mrq[0], &complete);
+	mmc_pre_req(host, &mrq[1], false);
+	wait_for_completion(&complete);
+	mmc_post_req(host, &mrq[0], 0);
+
+	ret = mmc_test_check_result(test, &mrq[0]);
+	if (ret) {
+		mmc_post_req(host, &mrq[1], ret);
+		return ret;
+	}
+
+	init_completion(&complete);
+	mmc_start_req(host, &mrq[1], &complete);
+	wait_for_completion(&complete);
+	mmc_post_req(host, &mrq[1], 0);
+
+	ret = mmc_test_check_result(test, &mrq[1]);
+	if (ret)
+		return ret;
+
+	for (i = 0;i < size * 2;i++) {
+		if (test->buffer[i] != (u8)i)
+			return RESULT_FAIL;
+	}
+
+	return 0;
+}
+
 #ifdef CONFIG_HIGHMEM
 
 static int mmc_test_write_high(struct mmc_test_card *test)
@@ -1038,6 +1118,12 @@ static const struct mmc_test_case mmc_test_cases[] = {
 
 #endif /* CONFIG_HIGHMEM */
 
+	{
+		.name = "Multi-block read with pre_req",
+		.prepare = mmc_test_prepare_read,
+		.run = mmc_test_multi_read_pre_req,
+		.cleanup = mmc_test_cleanup,
+	},
 };
 
 static DEFINE_MUTEX(mmc_test_lock);
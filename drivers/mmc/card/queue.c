@@ -89,6 +89,7 @@ static int mmc_queue_thread(void *d)
 		req = NULL;	/* Must be set to NULL at each iteration */
 
 		if (kthread_should_stop()) {
+			mmc_queue_cancel_prep(mq);
 			remove_all_req(mq);
 			break;
 		}
@@ -302,6 +303,19 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card, spinlock_t *lock
 			goto cleanup_queue;
 		}
 		sg_init_table(mq->sg, host->max_phys_segs);
+
+		/*
+		 * A second scatterlist for preparing the next request while
+		 * the current one is in flight. Not having one just means
+		 * requests are prepared one at a time.
+		 */
+		if (host->ops->pre_req) {
+			mq->prep.sg = kmalloc(sizeof(struct scatterlist) *
+				host->max_phys_segs, GFP_KERNEL);
+			if (mq->prep.sg)
+				sg_init_table(mq->prep.sg,
+					host->max_phys_segs);
+		}
 	}
 
 	init_MUTEX(&mq->thread_sem);
@@ -321,6 +335,8 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card, spinlock_t *lock
  	if (mq->sg)
 		kfree(mq->sg);
 	mq->sg = NULL;
+	kfree(mq->prep.sg);
+	mq->prep.sg = NULL;
 	if (mq->bounce_buf)
 		kfree(mq->bounce_buf);
 	mq->bounce_buf = NULL;
@@ -352,6 +368,9 @@ void mmc_cleanup_queue(struct mmc_queue *mq)
 	kfree(mq->sg);
 	mq->sg = NULL;
 
+	kfree(mq->prep.sg);
+	mq->prep.sg = NULL;
+
 	if (mq->bounce_buf)
 		kfree(mq->bounce_buf);
 	mq->bounce_buf = NULL;
@@ -472,3 +491,90 @@ void mmc_queue_bounce_post(struct mmc_queue *mq)
 	local_irq_restore(flags);
 }
 
+
+/*
+ * Called while the current request is being transferred: look at the
+ * next request on the queue and, if it can be issued in one go, build
+ * its scatterlist and let the host map it for DMA now rather than after
+ * the current request has completed.
+ */
+void mmc_queue_prep_next(struct mmc_queue *mq)
+{
+	struct request_queue *q = mq->queue;
+	struct mmc_host *host = mq->card->host;
+	struct mmc_queue_prep *prep = &mq->prep;
+	struct request *next = NULL;
+
+	if (!prep->sg || prep->req)
+		return;
+
+	spin_lock_irq(q->queue_lock);
+	if (!blk_queue_plugged(q))
+		next = blk_peek_request(q);
+	spin_unlock_irq(q->queue_lock);
+
+	/*
+	 * mmc_prep_request() has set REQ_DONTPREP on anything we peek at,
+	 * so the block layer will no longer merge into it.
+	 */
+	if (!next || !blk_fs_request(next) ||
+	    blk_rq_sectors(next) > host->max_blk_count)
+		return;
+
+	memset(&prep->mrq, 0, sizeof(prep->mrq));
+	memset(&prep->data, 0, sizeof(prep->data));
+	prep->mrq.data = &prep->data;
+	prep->data.blksz = 512;
+	prep->data.blocks = blk_rq_sectors(next);
+	prep->data.flags = rq_data_dir(next) == READ ?
+		MMC_DATA_READ : MMC_DATA_WRITE;
+	prep->data.sg = prep->sg;
+	prep->data.sg_len = blk_rq_map_sg(q, next, prep->sg);
+
+	mmc_pre_req(host, &prep->mrq, false);
+	prep->req = next;
+}
+
+/*
+ * If the request in mq->req was prepared by mmc_queue_prep_next(), make
+ * its scatterlist the current one and fill in @data from it. Returns 1
+ * if so, 0 if the caller has to map the request itself.
+ */
+int mmc_queue_use_prep(struct mmc_queue *mq, struct mmc_data *data)
+{
+	struct mmc_queue_prep *prep = &mq->prep;
+	struct scatterlist *sg;
+
+	if (!prep->req)
+		return 0;
+
+	if (prep->req != mq->req) {
+		/* Something was queued ahead of it; start over later */
+		mmc_queue_cancel_prep(mq);
+		return 0;
+	}
+
+	sg = mq->sg;
+	mq->sg = prep->sg;
+	prep->sg = sg;
+	prep->req = NULL;
+
+	data->sg = mq->sg;
+	data->sg_len = prep->data.sg_len;
+	data->host_cookie = prep->data.host_cookie;
+	return 1;
+}
+
+/*
+ * Drop a prepared request which is not going to be issued as prepared.
+ */
+void mmc_queue_cancel_prep(struct mmc_queue *mq)
+{
+	struct mmc_queue_prep *prep = &mq->prep;
+
+	if (!prep->req)
+		return;
+
+	mmc_post_req(mq->card->host, &prep->mrq, -EINVAL);
+	prep->req = NULL;
+}
@@ -1,9 +1,22 @@
 #ifndef MMC_QUEUE_H
 #define MMC_QUEUE_H
 
+#include <linux/mmc/core.h>
+
 struct request;
 struct task_struct;
 
+/*
+ * The request after the one being transferred, with its scatterlist
+ * already built and handed to the host's pre_req hook.
+ */
+struct mmc_queue_prep {
+	struct request		*req;
+	struct mmc_request	mrq;
+	struct mmc_data		data;
+	struct scatterlist	*sg;
+};
+
 struct mmc_queue {
 	struct mmc_card		*card;
 	struct task_struct	*thread;
@@ -17,6 +30,7 @@ struct mmc_queue {
 	char			*bounce_buf;
 	struct scatterlist	*bounce_sg;
 	unsigned int		bounce_sg_len;
+	struct mmc_queue_prep	prep;
 #ifdef CONFIG_MMC_BLOCK_PARANOID_RESUME
 	int			check_status;
 #endif
@@ -31,4 +45,8 @@ extern unsigned int mmc_queue_map_sg(struct mmc_queue *);
 extern void mmc_queue_bounce_pre(struct mmc_queue *);
 extern void mmc_queue_bounce_post(struct mmc_queue *);
 
+extern void mmc_queue_prep_next(struct mmc_queue *);
+extern int mmc_queue_use_prep(struct mmc_queue *, struct mmc_data *);
+extern void mmc_queue_cancel_prep(struct mmc_queue *);
+
 #endif
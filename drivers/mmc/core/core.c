@@ -206,6 +206,28 @@ static void mmc_wait_done(struct mmc_request *mrq)
 	complete(mrq->done_data);
 }
 
+/**
+ *	mmc_start_req - start a request without waiting for completion
+ *	@host: MMC host to start command
+ *	@mrq: MMC request to start
+ *	@complete: completion to signal when the request is done
+ *
+ *	Start a new MMC request for a host and return immediately, so
+ *	the caller can do other work, such as preparing the next request
+ *	with mmc_pre_req(), while this one is in progress. The caller
+ *	must wait for @complete before looking at the result.
+ */
+void mmc_start_req(struct mmc_host *host, struct mmc_request *mrq,
+	struct completion *complete)
+{
+	mrq->done_data = complete;
+	mrq->done = mmc_wait_done;
+
+	mmc_start_request(host, mrq);
+}
+
+EXPORT_SYMBOL(mmc_start_req);
+
 /**
  *	mmc_wait_for_req - start a request and wait for completion
  *	@host: MMC host to start command
@@ -219,16 +241,47 @@ void mmc_wait_for_req(struct mmc_host *host, struct mmc_request *mrq)
 {
 	DECLARE_COMPLETION_ONSTACK(complete);
 
-	mrq->done_data = &complete;
-	mrq->done = mmc_wait_done;
-
-	mmc_start_request(host, mrq);
+	mmc_start_req(host, mrq, &complete);
 
 	wait_for_completion(&complete);
 }
 
 EXPORT_SYMBOL(mmc_wait_for_req);
 
+/**
+ *	mmc_pre_req - let the host prepare a request
+ *	@host: MMC host that will run the request
+ *	@mrq: MMC request to prepare
+ *	@is_first_req: true if no other request is in progress
+ *
+ *	Gives the host driver a chance to map the request's data for DMA
+ *	ahead of time, typically while the previous request is still
+ *	transferring. Every prepared request must be passed to
+ *	mmc_post_req() once it has completed or is abandoned.
+ */
+void mmc_pre_req(struct mmc_host *host, struct mmc_request *mrq,
+	bool is_first_req)
+{
+	if (host->ops->pre_req)
+		host->ops->pre_req(host, mrq, is_first_req);
+}
+
+EXPORT_SYMBOL(mmc_pre_req);
+
+/**
+ *	mmc_post_req - undo the host's preparation of a request
+ *	@host: MMC host that ran the request
+ *	@mrq: MMC request that was prepared with mmc_pre_req()
+ *	@err: non-zero if the request was not run, or failed
+ */
+void mmc_post_req(struct mmc_host *host, struct mmc_request *mrq, int err)
+{
+	if (host->ops->post_req)
+		host->ops->post_req(host, mrq, err);
+}
+
+EXPORT_SYMBOL(mmc_post_req);
+
 /**
  *	mmc_wait_for_cmd - start a command and wait for completion
  *	@host: MMC host to start command
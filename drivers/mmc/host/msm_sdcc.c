@@ -304,8 +304,10 @@ msmsdcc_dma_complete_tlet(unsigned long data)
 		if (!mrq->data->error)
 			mrq->data->error = -EIO;
 	}
-	dma_unmap_sg(mmc_dev(host->mmc), host->dma.sg, host->dma.num_ents,
-		     host->dma.dir);
+	/* Buffers mapped by msmsdcc_pre_req are unmapped in post_req */
+	if (!mrq->data->host_cookie)
+		dma_unmap_sg(mmc_dev(host->mmc), host->dma.sg,
+			     host->dma.num_ents, host->dma.dir);
 
 	if (host->curr.user_pages) {
 		struct scatterlist *sg = host->dma.sg;
@@ -481,6 +483,12 @@ static int msmsdcc_config_dma(struct msmsdcc_host *host, struct mmc_data *data)
 	host->dma.hdr.complete_func = msmsdcc_dma_complete_func;
 	host->dma.hdr.crci_mask = msm_dmov_build_crci_mask(1, crci);
 
+	if (data->host_cookie) {
+		/* Already mapped by msmsdcc_pre_req */
+		dsb();
+		return 0;
+	}
+
 	n = dma_map_sg(mmc_dev(host->mmc), host->dma.sg,
 			host->dma.num_ents, host->dma.dir);
 	/* dsb inside dma_map_sg will write nc out to mem as well */
@@ -1100,6 +1108,56 @@ msmsdcc_request(struct mmc_host *mmc, struct mmc_request *mrq)
 	spin_unlock_irqrestore(&host->lock, flags);
 }
 
+/*
+ * Map the data buffers of a request for DMA ahead of time. On this
+ * cache architecture that means cleaning or invalidating every buffer
+ * line, which can now overlap with the transfer of the previous request.
+ */
+static void
+msmsdcc_pre_req(struct mmc_host *mmc, struct mmc_request *mrq,
+		bool is_first_req)
+{
+	struct msmsdcc_host *host = mmc_priv(mmc);
+	struct mmc_data *data = mrq->data;
+	enum dma_data_direction dir;
+
+	if (!data || data->host_cookie)
+		return;
+
+	/* Leave requests which will be done by PIO alone */
+	if (validate_dma(host, data) || data->sg_len > NR_SG)
+		return;
+
+	if (data->flags & MMC_DATA_READ)
+		dir = DMA_FROM_DEVICE;
+	else
+		dir = DMA_TO_DEVICE;
+
+	if (dma_map_sg(mmc_dev(mmc), data->sg, data->sg_len, dir) !=
+	    data->sg_len)
+		return;
+
+	data->host_cookie = 1;
+}
+
+static void
+msmsdcc_post_req(struct mmc_host *mmc, struct mmc_request *mrq, int err)
+{
+	struct mmc_data *data = mrq->data;
+	enum dma_data_direction dir;
+
+	if (!data || !data->host_cookie)
+		return;
+
+	if (data->flags & MMC_DATA_READ)
+		dir = DMA_FROM_DEVICE;
+	else
+		dir = DMA_TO_DEVICE;
+
+	dma_unmap_sg(mmc_dev(mmc), data->sg, data->sg_len, dir);
+	data->host_cookie = 0;
+}
+
 static void
 msmsdcc_set_ios(struct mmc_host *mmc, struct mmc_ios *ios)
 {
@@ -1212,6 +1270,8 @@ static void msmsdcc_enable_sdio_irq(struct mmc_host *mmc, int enable)
 
 static const struct mmc_host_ops msmsdcc_ops = {
 	.request	= msmsdcc_request,
+	.pre_req	= msmsdcc_pre_req,
+	.post_req	= msmsdcc_post_req,
 	.set_ios	= msmsdcc_set_ios,
 	.get_ro		= msmsdcc_get_ro,
 #ifdef CONFIG_MMC_MSM_SDIO_SUPPORT
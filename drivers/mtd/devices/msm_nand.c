@@ -48,6 +48,12 @@ unsigned crci_mask;
 #define MSM_NAND_DMA_BUFFER_SLOTS \
 	(MSM_NAND_DMA_BUFFER_SIZE / (sizeof(((atomic_t *)0)->counter) * 8))
 
+/* Number of pages whose command lists are chained into a single data
+ * mover submission by the single controller read/write paths.  Each
+ * page costs ~800 (read) or ~1000 (write) bytes of the DMA buffer.
+ */
+#define MSM_NAND_PIPELINE_PAGES 4
+
 #define MSM_NAND_CFG0_RAW 0xA80420C0
 #define MSM_NAND_CFG1_RAW 0x5045D
 
@@ -756,8 +762,8 @@ static int msm_nand_read_oob(struct mtd_info *mtd, loff_t from,
 	struct msm_nand_chip *chip = mtd->priv;
 
 	struct {
-		dmov_s cmd[8 * 5 + 2];
-		unsigned cmdptr;
+		dmov_s cmd[MSM_NAND_PIPELINE_PAGES][8 * 5 + 2];
+		unsigned cmdptr[MSM_NAND_PIPELINE_PAGES];
 		struct {
 			uint32_t cmd;
 			uint32_t addr0;
@@ -771,10 +777,12 @@ static int msm_nand_read_oob(struct mtd_info *mtd, loff_t from,
 				uint32_t flash_status;
 				uint32_t buffer_status;
 			} result[8];
-		} data;
+		} data[MSM_NAND_PIPELINE_PAGES];
 	} *dma_buffer;
 	dmov_s *cmd;
 	unsigned n;
+	unsigned b, batch;
+	uint32_t oob_len_left[MSM_NAND_PIPELINE_PAGES];
 	unsigned page = 0;
 	uint32_t oob_len;
 	uint32_t sectordatasize;
@@ -886,252 +894,276 @@ static int msm_nand_read_oob(struct mtd_info *mtd, loff_t from,
 		oob_col >>= 1;
 
 	err = 0;
-	while (page_count-- > 0) {
-		cmd = dma_buffer->cmd;
-
-		/* CMD / ADDR0 / ADDR1 / CHIPSEL program values */
-		if (ops->mode != MTD_OOB_RAW) {
-			dma_buffer->data.cmd = MSM_NAND_CMD_PAGE_READ_ECC;
-			dma_buffer->data.cfg0 =
-			(chip->CFG0 & ~(7U << 6))
-				| (((cwperpage-1) - start_sector) << 6);
-			dma_buffer->data.cfg1 = chip->CFG1;
-		} else {
-			dma_buffer->data.cmd = MSM_NAND_CMD_PAGE_READ;
-			dma_buffer->data.cfg0 = (MSM_NAND_CFG0_RAW
+	while (page_count > 0) {
+		/* build up to MSM_NAND_PIPELINE_PAGES command lists and
+		 * chain them behind one command pointer list, so the data
+		 * mover starts the next page read as soon as the previous
+		 * one has drained the controller buffer
+		 */
+		batch = min_t(unsigned, page_count, MSM_NAND_PIPELINE_PAGES);
+		for (b = 0; b < batch; b++) {
+			cmd = dma_buffer->cmd[b];
+
+			/* CMD / ADDR0 / ADDR1 / CHIPSEL program values */
+			if (ops->mode != MTD_OOB_RAW) {
+				dma_buffer->data[b].cmd =
+					MSM_NAND_CMD_PAGE_READ_ECC;
+				dma_buffer->data[b].cfg0 =
+				(chip->CFG0 & ~(7U << 6))
+					| (((cwperpage-1) - start_sector) << 6);
+				dma_buffer->data[b].cfg1 = chip->CFG1;
+			} else {
+				dma_buffer->data[b].cmd = MSM_NAND_CMD_PAGE_READ;
+				dma_buffer->data[b].cfg0 = (MSM_NAND_CFG0_RAW
 					& ~(7U << 6)) | ((cwperpage-1) << 6);
-			dma_buffer->data.cfg1 = MSM_NAND_CFG1_RAW |
+				dma_buffer->data[b].cfg1 = MSM_NAND_CFG1_RAW |
 					(chip->CFG1 & CFG1_WIDE_FLASH);
-		}
-
-		dma_buffer->data.addr0 = (page << 16) | oob_col;
-		/* qc example is (page >> 16) && 0xff !? */
-		dma_buffer->data.addr1 = (page >> 16) & 0xff;
-		/* flash0 + undoc bit */
-		dma_buffer->data.chipsel = 0 | 4;
-
-
-		/* GO bit for the EXEC register */
-		dma_buffer->data.exec = 1;
-
+			}
 
-		BUILD_BUG_ON(8 != ARRAY_SIZE(dma_buffer->data.result));
+			dma_buffer->data[b].addr0 = ((page + b) << 16) |
+				oob_col;
+			/* qc example is (page >> 16) && 0xff !? */
+			dma_buffer->data[b].addr1 = ((page + b) >> 16) & 0xff;
+			/* flash0 + undoc bit */
+			dma_buffer->data[b].chipsel = 0 | 4;
 
-		for (n = start_sector; n < cwperpage; n++) {
-			/* flash + buffer status return words */
-			dma_buffer->data.result[n].flash_status = 0xeeeeeeee;
-			dma_buffer->data.result[n].buffer_status = 0xeeeeeeee;
+			/* GO bit for the EXEC register */
+			dma_buffer->data[b].exec = 1;
 
-			/* block on cmd ready, then
-			 * write CMD / ADDR0 / ADDR1 / CHIPSEL
-			 * regs in a burst
-			 */
-			cmd->cmd = DST_CRCI_NAND_CMD;
-			cmd->src = msm_virt_to_dma(chip, &dma_buffer->data.cmd);
-			cmd->dst = MSM_NAND_FLASH_CMD;
-			if (n == start_sector)
-				cmd->len = 16;
-			else
-				cmd->len = 4;
-			cmd++;
+			BUILD_BUG_ON(8 != ARRAY_SIZE(dma_buffer->data[b].result));
 
-			if (n == start_sector) {
-				cmd->cmd = 0;
+			for (n = start_sector; n < cwperpage; n++) {
+				/* flash + buffer status return words */
+				dma_buffer->data[b].result[n].flash_status =
+					0xeeeeeeee;
+				dma_buffer->data[b].result[n].buffer_status =
+					0xeeeeeeee;
+
+				/* block on cmd ready, then
+				 * write CMD / ADDR0 / ADDR1 / CHIPSEL
+				 * regs in a burst
+				 */
+				cmd->cmd = DST_CRCI_NAND_CMD;
 				cmd->src = msm_virt_to_dma(chip,
-							&dma_buffer->data.cfg0);
-				cmd->dst = MSM_NAND_DEV0_CFG0;
-				cmd->len = 8;
+						&dma_buffer->data[b].cmd);
+				cmd->dst = MSM_NAND_FLASH_CMD;
+				if (n == start_sector)
+					cmd->len = 16;
+				else
+					cmd->len = 4;
 				cmd++;
 
-				dma_buffer->data.ecccfg = chip->ecc_buf_cfg;
+				if (n == start_sector) {
+					cmd->cmd = 0;
+					cmd->src = msm_virt_to_dma(chip,
+						&dma_buffer->data[b].cfg0);
+					cmd->dst = MSM_NAND_DEV0_CFG0;
+					cmd->len = 8;
+					cmd++;
+
+					dma_buffer->data[b].ecccfg =
+						chip->ecc_buf_cfg;
+					cmd->cmd = 0;
+					cmd->src = msm_virt_to_dma(chip,
+						&dma_buffer->data[b].ecccfg);
+					cmd->dst = MSM_NAND_EBI2_ECC_BUF_CFG;
+					cmd->len = 4;
+					cmd++;
+				}
+
+				/* kick the execute register */
 				cmd->cmd = 0;
 				cmd->src = msm_virt_to_dma(chip,
-						&dma_buffer->data.ecccfg);
-				cmd->dst = MSM_NAND_EBI2_ECC_BUF_CFG;
+						&dma_buffer->data[b].exec);
+				cmd->dst = MSM_NAND_EXEC_CMD;
 				cmd->len = 4;
 				cmd++;
-			}
-
-			/* kick the execute register */
-			cmd->cmd = 0;
-			cmd->src =
-				msm_virt_to_dma(chip, &dma_buffer->data.exec);
-			cmd->dst = MSM_NAND_EXEC_CMD;
-			cmd->len = 4;
-			cmd++;
-
-			/* block on data ready, then
-			 * read the status register
-			 */
-			cmd->cmd = SRC_CRCI_NAND_DATA;
-			cmd->src = MSM_NAND_FLASH_STATUS;
-			cmd->dst = msm_virt_to_dma(chip,
-						   &dma_buffer->data.result[n]);
-			/* MSM_NAND_FLASH_STATUS + MSM_NAND_BUFFER_STATUS */
-			cmd->len = 8;
-			cmd++;
 
-			/* read data block
-			 * (only valid if status says success)
-			 */
-			if (ops->datbuf) {
-				if (ops->mode != MTD_OOB_RAW)
-					sectordatasize = (n < (cwperpage - 1))
-					? 516 : (512 - ((cwperpage - 1) << 2));
-				else
-					sectordatasize = 528;
-
-				cmd->cmd = 0;
-				cmd->src = MSM_NAND_FLASH_BUFFER;
-				cmd->dst = data_dma_addr_curr;
-				data_dma_addr_curr += sectordatasize;
-				cmd->len = sectordatasize;
+				/* block on data ready, then
+				 * read the status register
+				 */
+				cmd->cmd = SRC_CRCI_NAND_DATA;
+				cmd->src = MSM_NAND_FLASH_STATUS;
+				cmd->dst = msm_virt_to_dma(chip,
+					&dma_buffer->data[b].result[n]);
+				/* MSM_NAND_FLASH_STATUS +
+				 * MSM_NAND_BUFFER_STATUS
+				 */
+				cmd->len = 8;
 				cmd++;
-			}
 
-			if (ops->oobbuf && (n == (cwperpage - 1)
-			     || ops->mode != MTD_OOB_AUTO)) {
-				cmd->cmd = 0;
-				if (n == (cwperpage - 1)) {
-					cmd->src = MSM_NAND_FLASH_BUFFER +
+				/* read data block
+				 * (only valid if status says success)
+				 */
+				if (ops->datbuf) {
+					if (ops->mode != MTD_OOB_RAW)
+						sectordatasize =
+						(n < (cwperpage - 1)) ? 516 :
 						(512 - ((cwperpage - 1) << 2));
-					sectoroobsize = (cwperpage << 2);
-					if (ops->mode != MTD_OOB_AUTO)
-						sectoroobsize += 10;
-				} else {
-					cmd->src = MSM_NAND_FLASH_BUFFER + 516;
-					sectoroobsize = 10;
-				}
+					else
+						sectordatasize = 528;
 
-				cmd->dst = oob_dma_addr_curr;
-				if (sectoroobsize < oob_len)
-					cmd->len = sectoroobsize;
-				else
-					cmd->len = oob_len;
-				oob_dma_addr_curr += cmd->len;
-				oob_len -= cmd->len;
-				if (cmd->len > 0)
+					cmd->cmd = 0;
+					cmd->src = MSM_NAND_FLASH_BUFFER;
+					cmd->dst = data_dma_addr_curr;
+					data_dma_addr_curr += sectordatasize;
+					cmd->len = sectordatasize;
 					cmd++;
+				}
+
+				if (ops->oobbuf && (n == (cwperpage - 1)
+				     || ops->mode != MTD_OOB_AUTO)) {
+					cmd->cmd = 0;
+					if (n == (cwperpage - 1)) {
+						cmd->src = MSM_NAND_FLASH_BUFFER
+						+ (512 - ((cwperpage - 1) << 2));
+						sectoroobsize = (cwperpage << 2);
+						if (ops->mode != MTD_OOB_AUTO)
+							sectoroobsize += 10;
+					} else {
+						cmd->src =
+						MSM_NAND_FLASH_BUFFER + 516;
+						sectoroobsize = 10;
+					}
+
+					cmd->dst = oob_dma_addr_curr;
+					if (sectoroobsize < oob_len)
+						cmd->len = sectoroobsize;
+					else
+						cmd->len = oob_len;
+					oob_dma_addr_curr += cmd->len;
+					oob_len -= cmd->len;
+					if (cmd->len > 0)
+						cmd++;
+				}
 			}
-		}
 
-		BUILD_BUG_ON(8 * 5 + 2 != ARRAY_SIZE(dma_buffer->cmd));
-		BUG_ON(cmd - dma_buffer->cmd > ARRAY_SIZE(dma_buffer->cmd));
-		dma_buffer->cmd[0].cmd |= CMD_OCB;
-		cmd[-1].cmd |= CMD_OCU | CMD_LC;
+			BUILD_BUG_ON(8 * 5 + 2 !=
+				     ARRAY_SIZE(dma_buffer->cmd[b]));
+			BUG_ON(cmd - dma_buffer->cmd[b] >
+			       ARRAY_SIZE(dma_buffer->cmd[b]));
+			dma_buffer->cmd[b][0].cmd |= CMD_OCB;
+			cmd[-1].cmd |= CMD_OCU | CMD_LC;
 
-		dma_buffer->cmdptr =
-			(msm_virt_to_dma(chip, dma_buffer->cmd) >> 3)
-			| CMD_PTR_LP;
+			dma_buffer->cmdptr[b] =
+				msm_virt_to_dma(chip, dma_buffer->cmd[b]) >> 3;
+			oob_len_left[b] = oob_len;
+		}
+		dma_buffer->cmdptr[batch - 1] |= CMD_PTR_LP;
 
 		dsb();
 		msm_dmov_exec_cmd(chip->dma_channel, crci_mask,
 			DMOV_CMD_PTR_LIST | DMOV_CMD_ADDR(msm_virt_to_dma(chip,
-			&dma_buffer->cmdptr)));
+			dma_buffer->cmdptr)));
 		dsb();
 
-		/* if any of the writes failed (0x10), or there
-		 * was a protection violation (0x100), we lose
-		 */
-		pageerr = rawerr = 0;
-		for (n = start_sector; n < cwperpage; n++) {
-			if (dma_buffer->data.result[n].flash_status & 0x110) {
-				rawerr = -EIO;
-				break;
+		for (b = 0; b < batch; b++) {
+			/* if any of the writes failed (0x10), or there
+			 * was a protection violation (0x100), we lose
+			 */
+			pageerr = rawerr = 0;
+			for (n = start_sector; n < cwperpage; n++) {
+				if (dma_buffer->data[b].result[n].flash_status
+						& 0x110) {
+					rawerr = -EIO;
+					break;
+				}
 			}
-		}
-		if (rawerr) {
-			if (ops->datbuf && ops->mode != MTD_OOB_RAW) {
-				uint8_t *datbuf = ops->datbuf +
-					pages_read * mtd->writesize;
+			if (rawerr) {
+				if (ops->datbuf && ops->mode != MTD_OOB_RAW) {
+					uint8_t *datbuf = ops->datbuf +
+						pages_read * mtd->writesize;
+					dma_addr_t page_dma_addr =
+						data_dma_addr +
+						pages_read * mtd->writesize;
+
+					dma_sync_single_for_cpu(chip->dev,
+						page_dma_addr, mtd->writesize,
+						DMA_BIDIRECTIONAL);
+
+					for (n = 0; n < mtd->writesize; n++) {
+						/* empty blocks read 0x54 at
+						 * these offsets
+						 */
+						if (n % 516 == 3 &&
+						    datbuf[n] == 0x54)
+							datbuf[n] = 0xff;
+						if (datbuf[n] != 0xff) {
+							pageerr = rawerr;
+							break;
+						}
+					}
 
-				dma_sync_single_for_cpu(chip->dev,
-					data_dma_addr_curr-mtd->writesize,
-					mtd->writesize, DMA_BIDIRECTIONAL);
+					dma_sync_single_for_device(chip->dev,
+						page_dma_addr, mtd->writesize,
+						DMA_BIDIRECTIONAL);
 
-				for (n = 0; n < mtd->writesize; n++) {
-					/* empty blocks read 0x54 at
-					 * these offsets
-					 */
-					if (n % 516 == 3 && datbuf[n] == 0x54)
-						datbuf[n] = 0xff;
-					if (datbuf[n] != 0xff) {
-						pageerr = rawerr;
-						break;
+				}
+				if (ops->oobbuf) {
+					for (n = 0; n < ops->ooblen; n++) {
+						if (ops->oobbuf[n] != 0xff) {
+							pageerr = rawerr;
+							break;
+						}
 					}
 				}
-
-				dma_sync_single_for_device(chip->dev,
-					data_dma_addr_curr-mtd->writesize,
-					mtd->writesize, DMA_BIDIRECTIONAL);
-
 			}
-			if (ops->oobbuf) {
-				for (n = 0; n < ops->ooblen; n++) {
-					if (ops->oobbuf[n] != 0xff) {
-						pageerr = rawerr;
+			if (pageerr) {
+				for (n = start_sector; n < cwperpage; n++) {
+					if (dma_buffer->data[b].result[n].
+							buffer_status & 0x8) {
+						/* not thread safe */
+						mtd->ecc_stats.failed++;
+						pageerr = -EBADMSG;
 						break;
 					}
 				}
 			}
-		}
-		if (pageerr) {
-			for (n = start_sector; n < cwperpage; n++) {
-				if (dma_buffer->data.result[n].buffer_status
-						& 0x8) {
-					/* not thread safe */
-					mtd->ecc_stats.failed++;
-					pageerr = -EBADMSG;
-					break;
-				}
-			}
-		}
-		if (!rawerr) { /* check for corretable errors */
-			for (n = start_sector; n < cwperpage; n++) {
-				ecc_errors = dma_buffer->data.
-					result[n].buffer_status & 0x7;
-				if (ecc_errors) {
-					total_ecc_errors += ecc_errors;
-					/* not thread safe */
-					mtd->ecc_stats.corrected += ecc_errors;
-					if (ecc_errors > 1)
-						pageerr = -EUCLEAN;
+			if (!rawerr) { /* check for corretable errors */
+				for (n = start_sector; n < cwperpage; n++) {
+					ecc_errors = dma_buffer->data[b].
+						result[n].buffer_status & 0x7;
+					if (ecc_errors) {
+						total_ecc_errors += ecc_errors;
+						/* not thread safe */
+						mtd->ecc_stats.corrected +=
+							ecc_errors;
+						if (ecc_errors > 1)
+							pageerr = -EUCLEAN;
+					}
 				}
 			}
-		}
-		if (pageerr && (pageerr != -EUCLEAN || err == 0))
-			err = pageerr;
+			if (pageerr && (pageerr != -EUCLEAN || err == 0))
+				err = pageerr;
 
 #if VERBOSE
-		if (rawerr && !pageerr) {
-			pr_err("msm_nand_read_oob %llx %x %x empty page\n",
-			       (loff_t)page * mtd->writesize, ops->len,
-			       ops->ooblen);
-		} else {
-			pr_info("status: %x %x %x %x %x %x %x %x %x \
-					%x %x %x %x %x %x %x \n",
-				dma_buffer->data.result[0].flash_status,
-				dma_buffer->data.result[0].buffer_status,
-				dma_buffer->data.result[1].flash_status,
-				dma_buffer->data.result[1].buffer_status,
-				dma_buffer->data.result[2].flash_status,
-				dma_buffer->data.result[2].buffer_status,
-				dma_buffer->data.result[3].flash_status,
-				dma_buffer->data.result[3].buffer_status,
-				dma_buffer->data.result[4].flash_status,
-				dma_buffer->data.result[4].buffer_status,
-				dma_buffer->data.result[5].flash_status,
-				dma_buffer->data.result[5].buffer_status,
-				dma_buffer->data.result[6].flash_status,
-				dma_buffer->data.result[6].buffer_status,
-				dma_buffer->data.result[7].flash_status,
-				dma_buffer->data.result[7].buffer_status);
-		}
+			if (rawerr && !pageerr) {
+				pr_err("msm_nand_read_oob %llx %x %x "
+				       "empty page\n",
+				       (loff_t)page * mtd->writesize, ops->len,
+				       ops->ooblen);
+			} else {
+				for (n = 0; n < cwperpage; n++)
+					pr_info("status[%d]: %x %x\n", n,
+					dma_buffer->data[b].result[n].
+						flash_status,
+					dma_buffer->data[b].result[n].
+						buffer_status);
+			}
 #endif
-		if (err && err != -EUCLEAN && err != -EBADMSG)
+			if (err && err != -EUCLEAN && err != -EBADMSG) {
+				/* the rest of the batch was read behind
+				 * this page; do not report its oob
+				 */
+				oob_len = oob_len_left[b];
+				break;
+			}
+			pages_read++;
+			page++;
+			page_count--;
+		}
+		if (b < batch)
 			break;
-		pages_read++;
-		page++;
 	}
 	msm_nand_release_dma_buffer(chip, dma_buffer, sizeof(*dma_buffer));
 
@@ -2031,8 +2063,8 @@ msm_nand_write_oob(struct mtd_info *mtd, loff_t to, struct mtd_oob_ops *ops)
 {
 	struct msm_nand_chip *chip = mtd->priv;
 	struct {
-		dmov_s cmd[8 * 7 + 2];
-		unsigned cmdptr;
+		dmov_s cmd[MSM_NAND_PIPELINE_PAGES][8 * 7 + 2];
+		unsigned cmdptr[MSM_NAND_PIPELINE_PAGES];
 		struct {
 			uint32_t cmd;
 			uint32_t addr0;
@@ -2045,10 +2077,12 @@ msm_nand_write_oob(struct mtd_info *mtd, loff_t to, struct mtd_oob_ops *ops)
 			uint32_t clrfstatus;
 			uint32_t clrrstatus;
 			uint32_t flash_status[8];
-		} data;
+		} data[MSM_NAND_PIPELINE_PAGES];
 	} *dma_buffer;
 	dmov_s *cmd;
 	unsigned n;
+	unsigned b, batch;
+	uint32_t oob_len_left[MSM_NAND_PIPELINE_PAGES];
 	unsigned page = 0;
 	uint32_t oob_len;
 	uint32_t sectordatawritesize;
@@ -2059,6 +2093,7 @@ msm_nand_write_oob(struct mtd_info *mtd, loff_t to, struct mtd_oob_ops *ops)
 	dma_addr_t oob_dma_addr_curr = 0;
 	unsigned page_count;
 	unsigned pages_written = 0;
+	unsigned pages_per_block;
 	unsigned cwperpage;
 
 	if (mtd->writesize == 2048)
@@ -2069,6 +2104,7 @@ msm_nand_write_oob(struct mtd_info *mtd, loff_t to, struct mtd_oob_ops *ops)
 
 	oob_len = ops->ooblen;
 	cwperpage = (mtd->writesize >> 9);
+	pages_per_block = mtd->erasesize / mtd->writesize;
 
 	if (to & (mtd->writesize - 1)) {
 		pr_err("%s: unsupported to, 0x%llx\n", __func__, to);
@@ -2141,186 +2177,225 @@ msm_nand_write_oob(struct mtd_info *mtd, loff_t to, struct mtd_oob_ops *ops)
 	wait_event(chip->wait_queue, (dma_buffer =
 			msm_nand_get_dma_buffer(chip, sizeof(*dma_buffer))));
 
-	while (page_count-- > 0) {
-		cmd = dma_buffer->cmd;
-
-		/* CMD / ADDR0 / ADDR1 / CHIPSEL program values */
-		if (ops->mode != MTD_OOB_RAW) {
-			dma_buffer->data.cfg0 = chip->CFG0;
-			dma_buffer->data.cfg1 = chip->CFG1;
-		} else {
-			dma_buffer->data.cfg0 = (MSM_NAND_CFG0_RAW &
+	while (page_count > 0) {
+		/* chain up to MSM_NAND_PIPELINE_PAGES page programs behind
+		 * one command pointer list; the data mover loads the next
+		 * page into the controller buffer as soon as the previous
+		 * program has been started and its status collected.
+		 * The data mover cannot stop the chain when a program
+		 * fails, so the pages queued behind a failed one are
+		 * programmed too.  A batch never crosses an erase block,
+		 * so those pages are always in the block that failed,
+		 * which the caller retires.
+		 */
+		batch = min_t(unsigned, page_count, MSM_NAND_PIPELINE_PAGES);
+		batch = min_t(unsigned, batch,
+			      pages_per_block - (page % pages_per_block));
+		for (b = 0; b < batch; b++) {
+			cmd = dma_buffer->cmd[b];
+
+			/* CMD / ADDR0 / ADDR1 / CHIPSEL program values */
+			if (ops->mode != MTD_OOB_RAW) {
+				dma_buffer->data[b].cfg0 = chip->CFG0;
+				dma_buffer->data[b].cfg1 = chip->CFG1;
+			} else {
+				dma_buffer->data[b].cfg0 = (MSM_NAND_CFG0_RAW &
 					~(7U << 6)) | ((cwperpage-1) << 6);
-			dma_buffer->data.cfg1 = MSM_NAND_CFG1_RAW |
-						(chip->CFG1 & CFG1_WIDE_FLASH);
-		}
-
-		dma_buffer->data.cmd = MSM_NAND_CMD_PRG_PAGE;
-		dma_buffer->data.addr0 = page << 16;
-		dma_buffer->data.addr1 = (page >> 16) & 0xff;
-		dma_buffer->data.chipsel = 0 | 4; /* flash0 + undoc bit */
+				dma_buffer->data[b].cfg1 = MSM_NAND_CFG1_RAW |
+					(chip->CFG1 & CFG1_WIDE_FLASH);
+			}
 
+			dma_buffer->data[b].cmd = MSM_NAND_CMD_PRG_PAGE;
+			dma_buffer->data[b].addr0 = (page + b) << 16;
+			dma_buffer->data[b].addr1 = ((page + b) >> 16) & 0xff;
+			/* flash0 + undoc bit */
+			dma_buffer->data[b].chipsel = 0 | 4;
 
 			/* GO bit for the EXEC register */
-		dma_buffer->data.exec = 1;
-		dma_buffer->data.clrfstatus = 0x00000020;
-		dma_buffer->data.clrrstatus = 0x000000C0;
+			dma_buffer->data[b].exec = 1;
+			dma_buffer->data[b].clrfstatus = 0x00000020;
+			dma_buffer->data[b].clrrstatus = 0x000000C0;
+
+			BUILD_BUG_ON(8 !=
+				ARRAY_SIZE(dma_buffer->data[b].flash_status));
+
+			for (n = 0; n < cwperpage ; n++) {
+				/* status return words */
+				dma_buffer->data[b].flash_status[n] =
+					0xeeeeeeee;
+				/* block on cmd ready, then
+				 * write CMD / ADDR0 / ADDR1 / CHIPSEL regs
+				 * in a burst
+				 */
+				cmd->cmd = DST_CRCI_NAND_CMD;
+				cmd->src = msm_virt_to_dma(chip,
+						&dma_buffer->data[b].cmd);
+				cmd->dst = MSM_NAND_FLASH_CMD;
+				if (n == 0)
+					cmd->len = 16;
+				else
+					cmd->len = 4;
+				cmd++;
 
-		BUILD_BUG_ON(8 != ARRAY_SIZE(dma_buffer->data.flash_status));
+				if (n == 0) {
+					cmd->cmd = 0;
+					cmd->src = msm_virt_to_dma(chip,
+						&dma_buffer->data[b].cfg0);
+					cmd->dst = MSM_NAND_DEV0_CFG0;
+					cmd->len = 8;
+					cmd++;
 
-		for (n = 0; n < cwperpage ; n++) {
-			/* status return words */
-			dma_buffer->data.flash_status[n] = 0xeeeeeeee;
-			/* block on cmd ready, then
-			 * write CMD / ADDR0 / ADDR1 / CHIPSEL regs in a burst
-			 */
-			cmd->cmd = DST_CRCI_NAND_CMD;
-			cmd->src =
-				msm_virt_to_dma(chip, &dma_buffer->data.cmd);
-			cmd->dst = MSM_NAND_FLASH_CMD;
-			if (n == 0)
-				cmd->len = 16;
-			else
-				cmd->len = 4;
-			cmd++;
+					dma_buffer->data[b].ecccfg =
+						chip->ecc_buf_cfg;
+					cmd->cmd = 0;
+					cmd->src = msm_virt_to_dma(chip,
+						&dma_buffer->data[b].ecccfg);
+					cmd->dst = MSM_NAND_EBI2_ECC_BUF_CFG;
+					cmd->len = 4;
+					cmd++;
+				}
+
+				/* write data block */
+				if (ops->mode != MTD_OOB_RAW)
+					sectordatawritesize =
+						(n < (cwperpage - 1)) ? 516 :
+						(512 - ((cwperpage - 1) << 2));
+				else
+					sectordatawritesize = 528;
 
-			if (n == 0) {
 				cmd->cmd = 0;
-				cmd->src = msm_virt_to_dma(chip,
-							&dma_buffer->data.cfg0);
-				cmd->dst = MSM_NAND_DEV0_CFG0;
-				cmd->len = 8;
+				cmd->src = data_dma_addr_curr;
+				data_dma_addr_curr += sectordatawritesize;
+				cmd->dst = MSM_NAND_FLASH_BUFFER;
+				cmd->len = sectordatawritesize;
 				cmd++;
 
-				dma_buffer->data.ecccfg = chip->ecc_buf_cfg;
+				if (ops->oobbuf) {
+					if (n == (cwperpage - 1)) {
+						cmd->cmd = 0;
+						cmd->src = oob_dma_addr_curr;
+						cmd->dst = MSM_NAND_FLASH_BUFFER
+						+ (512 - ((cwperpage - 1) << 2));
+						if ((cwperpage << 2) < oob_len)
+							cmd->len =
+							(cwperpage << 2);
+						else
+							cmd->len = oob_len;
+						oob_dma_addr_curr += cmd->len;
+						oob_len -= cmd->len;
+						if (cmd->len > 0)
+							cmd++;
+					}
+					if (ops->mode != MTD_OOB_AUTO) {
+						/* skip ecc bytes in oobbuf */
+						if (oob_len < 10) {
+							oob_dma_addr_curr += 10;
+							oob_len -= 10;
+						} else {
+							oob_dma_addr_curr +=
+								oob_len;
+							oob_len = 0;
+						}
+					}
+				}
+
+				/* kick the execute register */
 				cmd->cmd = 0;
 				cmd->src = msm_virt_to_dma(chip,
-						 &dma_buffer->data.ecccfg);
-				cmd->dst = MSM_NAND_EBI2_ECC_BUF_CFG;
+						&dma_buffer->data[b].exec);
+				cmd->dst = MSM_NAND_EXEC_CMD;
 				cmd->len = 4;
 				cmd++;
-			}
-
-				/* write data block */
-			if (ops->mode != MTD_OOB_RAW)
-				sectordatawritesize = (n < (cwperpage - 1)) ?
-					516 : (512 - ((cwperpage - 1) << 2));
-			else
-				sectordatawritesize = 528;
-
-			cmd->cmd = 0;
-			cmd->src = data_dma_addr_curr;
-			data_dma_addr_curr += sectordatawritesize;
-			cmd->dst = MSM_NAND_FLASH_BUFFER;
-			cmd->len = sectordatawritesize;
-			cmd++;
 
-			if (ops->oobbuf) {
-				if (n == (cwperpage - 1)) {
-					cmd->cmd = 0;
-					cmd->src = oob_dma_addr_curr;
-					cmd->dst = MSM_NAND_FLASH_BUFFER +
-						(512 - ((cwperpage - 1) << 2));
-					if ((cwperpage << 2) < oob_len)
-						cmd->len = (cwperpage << 2);
-					else
-						cmd->len = oob_len;
-					oob_dma_addr_curr += cmd->len;
-					oob_len -= cmd->len;
-					if (cmd->len > 0)
-						cmd++;
-				}
-				if (ops->mode != MTD_OOB_AUTO) {
-					/* skip ecc bytes in oobbuf */
-					if (oob_len < 10) {
-						oob_dma_addr_curr += 10;
-						oob_len -= 10;
-					} else {
-						oob_dma_addr_curr += oob_len;
-						oob_len = 0;
-					}
-				}
-			}
-
-			/* kick the execute register */
-			cmd->cmd = 0;
-			cmd->src =
-				msm_virt_to_dma(chip, &dma_buffer->data.exec);
-			cmd->dst = MSM_NAND_EXEC_CMD;
-			cmd->len = 4;
-			cmd++;
+				/* block on data ready, then
+				 * read the status register
+				 */
+				cmd->cmd = SRC_CRCI_NAND_DATA;
+				cmd->src = MSM_NAND_FLASH_STATUS;
+				cmd->dst = msm_virt_to_dma(chip,
+					&dma_buffer->data[b].flash_status[n]);
+				cmd->len = 4;
+				cmd++;
 
-			/* block on data ready, then
-			 * read the status register
-			 */
-			cmd->cmd = SRC_CRCI_NAND_DATA;
-			cmd->src = MSM_NAND_FLASH_STATUS;
-			cmd->dst = msm_virt_to_dma(chip,
-					     &dma_buffer->data.flash_status[n]);
-			cmd->len = 4;
-			cmd++;
+				cmd->cmd = 0;
+				cmd->src = msm_virt_to_dma(chip,
+					&dma_buffer->data[b].clrfstatus);
+				cmd->dst = MSM_NAND_FLASH_STATUS;
+				cmd->len = 4;
+				cmd++;
 
-			cmd->cmd = 0;
-			cmd->src = msm_virt_to_dma(chip,
-						&dma_buffer->data.clrfstatus);
-			cmd->dst = MSM_NAND_FLASH_STATUS;
-			cmd->len = 4;
-			cmd++;
+				cmd->cmd = 0;
+				cmd->src = msm_virt_to_dma(chip,
+					&dma_buffer->data[b].clrrstatus);
+				cmd->dst = MSM_NAND_READ_STATUS;
+				cmd->len = 4;
+				cmd++;
 
-			cmd->cmd = 0;
-			cmd->src = msm_virt_to_dma(chip,
-						&dma_buffer->data.clrrstatus);
-			cmd->dst = MSM_NAND_READ_STATUS;
-			cmd->len = 4;
-			cmd++;
+			}
 
+			dma_buffer->cmd[b][0].cmd |= CMD_OCB;
+			cmd[-1].cmd |= CMD_OCU | CMD_LC;
+			BUILD_BUG_ON(8 * 7 + 2 !=
+				     ARRAY_SIZE(dma_buffer->cmd[b]));
+			BUG_ON(cmd - dma_buffer->cmd[b] >
+			       ARRAY_SIZE(dma_buffer->cmd[b]));
+			dma_buffer->cmdptr[b] =
+				msm_virt_to_dma(chip, dma_buffer->cmd[b]) >> 3;
+			oob_len_left[b] = oob_len;
 		}
-
-		dma_buffer->cmd[0].cmd |= CMD_OCB;
-		cmd[-1].cmd |= CMD_OCU | CMD_LC;
-		BUILD_BUG_ON(8 * 7 + 2 != ARRAY_SIZE(dma_buffer->cmd));
-		BUG_ON(cmd - dma_buffer->cmd > ARRAY_SIZE(dma_buffer->cmd));
-		dma_buffer->cmdptr =
-			(msm_virt_to_dma(chip, dma_buffer->cmd) >> 3) |
-			CMD_PTR_LP;
+		dma_buffer->cmdptr[batch - 1] |= CMD_PTR_LP;
 
 		dsb();
 		msm_dmov_exec_cmd(chip->dma_channel, crci_mask,
 			DMOV_CMD_PTR_LIST | DMOV_CMD_ADDR(
-				msm_virt_to_dma(chip, &dma_buffer->cmdptr)));
+				msm_virt_to_dma(chip, dma_buffer->cmdptr)));
 		dsb();
 
-		/* if any of the writes failed (0x10), or there was a
-		 * protection violation (0x100), or the program success
-		 * bit (0x80) is unset, we lose
-		 */
-		err = 0;
-		for (n = 0; n < cwperpage; n++) {
-			if (dma_buffer->data.flash_status[n] & 0x110) {
-				err = -EIO;
-				break;
-			}
-			if (!(dma_buffer->data.flash_status[n] & 0x80)) {
-				err = -EIO;
-				break;
+		for (b = 0; b < batch; b++) {
+			/* if any of the writes failed (0x10), or there was a
+			 * protection violation (0x100), or the program
+			 * success bit (0x80) is unset, we lose
+			 */
+			err = 0;
+			for (n = 0; n < cwperpage; n++) {
+				if (dma_buffer->data[b].flash_status[n] &
+						0x110) {
+					err = -EIO;
+					break;
+				}
+				if (!(dma_buffer->data[b].flash_status[n] &
+						0x80)) {
+					err = -EIO;
+					break;
+				}
 			}
-		}
 
 #if VERBOSE
-		pr_info("write pg %d: status: %x %x %x %x %x %x %x %x\n", page,
-			dma_buffer->data.flash_status[0],
-			dma_buffer->data.flash_status[1],
-			dma_buffer->data.flash_status[2],
-			dma_buffer->data.flash_status[3],
-			dma_buffer->data.flash_status[4],
-			dma_buffer->data.flash_status[5],
-			dma_buffer->data.flash_status[6],
-			dma_buffer->data.flash_status[7]);
+			pr_info("write pg %d: status: %x %x %x %x %x %x %x %x\n",
+				page,
+				dma_buffer->data[b].flash_status[0],
+				dma_buffer->data[b].flash_status[1],
+				dma_buffer->data[b].flash_status[2],
+				dma_buffer->data[b].flash_status[3],
+				dma_buffer->data[b].flash_status[4],
+				dma_buffer->data[b].flash_status[5],
+				dma_buffer->data[b].flash_status[6],
+				dma_buffer->data[b].flash_status[7]);
 #endif
+			if (err) {
+				/* report only the pages before the failed
+				 * one as written, even though the ones
+				 * queued behind it were programmed too
+				 */
+				oob_len = oob_len_left[b];
+				break;
+			}
+			pages_written++;
+			page++;
+			page_count--;
+		}
 		if (err)
 			break;
-		pages_written++;
-		page++;
 	}
 	if (ops->mode != MTD_OOB_RAW)
 		ops->retlen = mtd->writesize * pages_written;
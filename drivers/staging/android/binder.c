@@ -590,6 +590,20 @@ static struct binder_buffer *binder_buffer_lookup(struct binder_proc *proc,
 	return NULL;
 }
 
+/* Free the pages of a range that were allocated but not mapped yet */
+static void binder_free_unmapped_pages(struct binder_proc *proc,
+				       void *start, void *end)
+{
+	void *page_addr;
+	struct page **page;
+
+	for (page_addr = start; page_addr < end; page_addr += PAGE_SIZE) {
+		page = &proc->pages[(page_addr - proc->buffer) / PAGE_SIZE];
+		__free_page(*page);
+		*page = NULL;
+	}
+}
+
 static int binder_update_page_range(struct binder_proc *proc, int allocate,
 				    void *start, void *end,
 				    struct vm_area_struct *vma)
@@ -599,6 +613,7 @@ static int binder_update_page_range(struct binder_proc *proc, int allocate,
 	struct vm_struct tmp_area;
 	struct page **page;
 	struct mm_struct *mm;
+	unsigned long nr_pages, i, nr;
 
 	binder_debug(BINDER_DEBUG_BUFFER_ALLOC,
 		     "binder: %d: %s pages %p-%p\n", proc->pid,
@@ -626,18 +641,28 @@ static int binder_update_page_range(struct binder_proc *proc, int allocate,
 		goto err_no_vma;
 	}
 
+	nr_pages = (end - start) / PAGE_SIZE;
+	page = &proc->pages[(start - proc->buffer) / PAGE_SIZE];
+	for (i = 0; i < nr_pages; i++)
+		BUG_ON(page[i]);
+	for (i = 0; i < nr_pages; i += nr) {
+		nr = alloc_pages_bulk_array(GFP_KERNEL | __GFP_ZERO,
+					    nr_pages - i, page + i);
+		if (nr == 0) {
+			printk(KERN_ERR "binder: %d: binder_alloc_buf failed "
+			       "for page at %p\n", proc->pid,
+			       start + i * PAGE_SIZE);
+			binder_free_unmapped_pages(proc, start,
+						   start + i * PAGE_SIZE);
+			goto err_no_vma;
+		}
+	}
+
 	for (page_addr = start; page_addr < end; page_addr += PAGE_SIZE) {
 		int ret;
 		struct page **page_array_ptr;
 		page = &proc->pages[(page_addr - proc->buffer) / PAGE_SIZE];
 
-		BUG_ON(*page);
-		*page = alloc_page(GFP_KERNEL | __GFP_ZERO);
-		if (*page == NULL) {
-			printk(KERN_ERR "binder: %d: binder_alloc_buf failed "
-			       "for page at %p\n", proc->pid, page_addr);
-			goto err_alloc_page_failed;
-		}
 		tmp_area.addr = page_addr;
 		tmp_area.size = PAGE_SIZE + PAGE_SIZE /* guard page? */;
 		page_array_ptr = page;
@@ -646,6 +671,8 @@ static int binder_update_page_range(struct binder_proc *proc, int allocate,
 			printk(KERN_ERR "binder: %d: binder_alloc_buf failed "
 			       "to map page at %p in kernel\n",
 			       proc->pid, page_addr);
+			binder_free_unmapped_pages(proc, page_addr + PAGE_SIZE,
+						   end);
 			goto err_map_kernel_failed;
 		}
 		user_page_addr =
@@ -655,6 +682,8 @@ static int binder_update_page_range(struct binder_proc *proc, int allocate,
 			printk(KERN_ERR "binder: %d: binder_alloc_buf failed "
 			       "to map page at %lx in userspace\n",
 			       proc->pid, user_page_addr);
+			binder_free_unmapped_pages(proc, page_addr + PAGE_SIZE,
+						   end);
 			goto err_vm_insert_page_failed;
 		}
 		/* vm_insert_page does not seem to increment the refcount */
@@ -677,8 +706,6 @@ err_vm_insert_page_failed:
 err_map_kernel_failed:
 		__free_page(*page);
 		*page = NULL;
-err_alloc_page_failed:
-		;
 	}
 err_no_vma:
 	if (mm) {
@@ -16,6 +16,9 @@
  * percentage of the cached memory is locked this can be very inaccurate
  * and processes may not get killed until the normal oom killer is triggered.
  *
+ * Set /proc/sys/vm/soft_reclaim_free_kbytes above the largest minfree level
+ * to have kswapd free clean caches before these thresholds are reached.
+ *
  * Copyright (C) 2007-2008 Google, Inc.
  *
  * This software is licensed under the terms of the GNU General Public
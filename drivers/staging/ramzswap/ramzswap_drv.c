@@ -0,0 +1,691 @@
+/*
+ * Compressed RAM based swap device
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Creates /dev/ramzswapN block devices which store each page written to
+ * them LZO compressed in memory. The intended use is as a swap device:
+ * anonymous pages of background applications are then kept, at a
+ * fraction of their size, rather than the application being killed
+ * by the low memory killer.
+ *
+ * Only whole, page aligned pages may be read or written. Slots are
+ * released when the swap code tells us, through swap_slot_free_notify,
+ * that they no longer hold data, or when they are discarded.
+ */
+
+#define KMSG_COMPONENT "ramzswap"
+#define pr_fmt(fmt) KMSG_COMPONENT ": " fmt
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/bio.h>
+#include <linux/bitops.h>
+#include <linux/blkdev.h>
+#include <linux/buffer_head.h>
+#include <linux/device.h>
+#include <linux/genhd.h>
+#include <linux/highmem.h>
+#include <linux/lzo.h>
+#include <linux/string.h>
+#include <linux/swap.h>
+#include <linux/vmalloc.h>
+
+#include "ramzswap_drv.h"
+
+static int ramzswap_major;
+static struct ramzswap *devices;
+
+/* Module parameters */
+static unsigned int num_devices = 1;
+static unsigned long disksize_kb;
+
+static void ramzswap_stat_inc(struct ramzswap *rzs, u64 *v)
+{
+	spin_lock(&rzs->slot_lock);
+	(*v)++;
+	spin_unlock(&rzs->slot_lock);
+}
+
+static int page_zero_filled(void *ptr)
+{
+	unsigned int pos;
+	unsigned long *page = ptr;
+
+	for (pos = 0; pos != PAGE_SIZE / sizeof(*page); pos++) {
+		if (page[pos])
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Release whatever is stored in a slot. Called with slot_lock held.
+ */
+static void ramzswap_free_slot(struct ramzswap *rzs, size_t index)
+{
+	struct ramzswap_slot *slot = &rzs->table[index];
+
+	if (slot->flags & RZS_ZERO) {
+		rzs->stats.pages_zero--;
+		rzs->stats.pages_stored--;
+		slot->flags = 0;
+		return;
+	}
+
+	if (!slot->page)
+		return;
+
+	if (slot->flags & RZS_UNCOMPRESSED) {
+		__free_page(slot->page);
+		rzs->stats.pages_expand--;
+	} else {
+		zobj_free(rzs->mem_pool, slot->size, slot->page,
+				slot->offset);
+		if (slot->size <= PAGE_SIZE / 2)
+			rzs->stats.good_compress--;
+	}
+
+	rzs->stats.compr_size -= slot->size;
+	rzs->stats.pages_stored--;
+
+	slot->page = NULL;
+	slot->offset = 0;
+	slot->size = 0;
+	slot->flags = 0;
+}
+
+static void ramzswap_free_slots(struct ramzswap *rzs, size_t index,
+		size_t count)
+{
+	spin_lock(&rzs->slot_lock);
+	while (count--)
+		ramzswap_free_slot(rzs, index++);
+	spin_unlock(&rzs->slot_lock);
+}
+
+static int ramzswap_read_page(struct ramzswap *rzs, struct page *page,
+		size_t index)
+{
+	struct ramzswap_slot *slot = &rzs->table[index];
+	unsigned char *src, *dst;
+	size_t clen = PAGE_SIZE;
+	int ret = 0;
+
+	dst = kmap_atomic(page, KM_USER0);
+
+	/*
+	 * Hold slot_lock across the decompression so the slot cannot be
+	 * freed or rewritten under us.
+	 */
+	spin_lock(&rzs->slot_lock);
+	if (!slot->page) {
+		/* Zero page, or a slot that was never written */
+		spin_unlock(&rzs->slot_lock);
+		memset(dst, 0, PAGE_SIZE);
+		goto out;
+	}
+
+	src = kmap_atomic(slot->page, KM_USER1);
+	if (slot->flags & RZS_UNCOMPRESSED)
+		memcpy(dst, src, PAGE_SIZE);
+	else
+		ret = lzo1x_decompress_safe(src + slot->offset, slot->size,
+				dst, &clen);
+	kunmap_atomic(src, KM_USER1);
+	spin_unlock(&rzs->slot_lock);
+
+	if (unlikely(ret != LZO_E_OK || clen != PAGE_SIZE)) {
+		pr_err("decompression failed, err=%d, page=%zu\n",
+			ret, index);
+		ret = -EIO;
+	}
+
+out:
+	kunmap_atomic(dst, KM_USER0);
+	flush_dcache_page(page);
+	return ret;
+}
+
+static int ramzswap_write_page(struct ramzswap *rzs, struct page *page,
+		size_t index)
+{
+	struct ramzswap_slot new = { NULL, 0, 0, 0 };
+	unsigned char *src, *dst;
+	size_t clen;
+	int ret;
+
+	mutex_lock(&rzs->lock);
+
+	src = kmap_atomic(page, KM_USER0);
+	if (page_zero_filled(src)) {
+		kunmap_atomic(src, KM_USER0);
+		new.flags = RZS_ZERO;
+		goto store;
+	}
+
+	ret = lzo1x_1_compress(src, PAGE_SIZE, rzs->compress_buffer, &clen,
+			rzs->compress_workmem);
+	kunmap_atomic(src, KM_USER0);
+	if (unlikely(ret != LZO_E_OK)) {
+		mutex_unlock(&rzs->lock);
+		pr_err("compression failed, err=%d, page=%zu\n", ret, index);
+		return -EIO;
+	}
+
+	if (unlikely(clen > ZOBJ_MAX_SIZE)) {
+		/* Not worth compressing, keep the page as it is */
+		clen = PAGE_SIZE;
+		new.page = alloc_page(GFP_NOIO | __GFP_HIGHMEM | __GFP_NOWARN);
+		if (!new.page) {
+			mutex_unlock(&rzs->lock);
+			return -ENOMEM;
+		}
+		new.flags = RZS_UNCOMPRESSED;
+
+		src = kmap_atomic(page, KM_USER0);
+		dst = kmap_atomic(new.page, KM_USER1);
+		memcpy(dst, src, PAGE_SIZE);
+		kunmap_atomic(dst, KM_USER1);
+		kunmap_atomic(src, KM_USER0);
+	} else {
+		ret = zobj_malloc(rzs->mem_pool, clen, &new.page, &new.offset,
+				GFP_NOIO | __GFP_HIGHMEM | __GFP_NOWARN);
+		if (ret) {
+			mutex_unlock(&rzs->lock);
+			return ret;
+		}
+
+		dst = kmap_atomic(new.page, KM_USER1);
+		memcpy(dst + new.offset, rzs->compress_buffer, clen);
+		kunmap_atomic(dst, KM_USER1);
+	}
+	new.size = clen;
+
+store:
+	mutex_unlock(&rzs->lock);
+
+	spin_lock(&rzs->slot_lock);
+	ramzswap_free_slot(rzs, index);
+	rzs->table[index] = new;
+
+	rzs->stats.pages_stored++;
+	if (new.flags & RZS_ZERO)
+		rzs->stats.pages_zero++;
+	else if (new.flags & RZS_UNCOMPRESSED)
+		rzs->stats.pages_expand++;
+	else if (new.size <= PAGE_SIZE / 2)
+		rzs->stats.good_compress++;
+	rzs->stats.compr_size += new.size;
+	spin_unlock(&rzs->slot_lock);
+
+	return 0;
+}
+
+/*
+ * Free all slots entirely covered by a discard request.
+ */
+static void ramzswap_discard(struct ramzswap *rzs, struct bio *bio)
+{
+	sector_t start = bio->bi_sector;
+	sector_t end = start + (bio->bi_size >> SECTOR_SHIFT);
+
+	start = ALIGN(start, SECTORS_PER_PAGE);
+	end &= ~((sector_t)SECTORS_PER_PAGE - 1);
+	if (start < end)
+		ramzswap_free_slots(rzs, start >> SECTORS_PER_PAGE_SHIFT,
+				(end - start) >> SECTORS_PER_PAGE_SHIFT);
+
+	ramzswap_stat_inc(rzs, &rzs->stats.discard);
+}
+
+/*
+ * Check if request is within bounds and page aligned.
+ */
+static inline int valid_io_request(struct ramzswap *rzs, struct bio *bio)
+{
+	if (unlikely(
+		(bio->bi_sector >= (rzs->disksize >> SECTOR_SHIFT)) ||
+		(bio->bi_sector & (SECTORS_PER_PAGE - 1)) ||
+		(bio->bi_size & (PAGE_SIZE - 1)) ||
+		((rzs->disksize >> SECTOR_SHIFT) - bio->bi_sector <
+			(bio->bi_size >> SECTOR_SHIFT)))) {
+
+		return 0;
+	}
+
+	return 1;
+}
+
+static int ramzswap_make_request(struct request_queue *queue, struct bio *bio)
+{
+	struct ramzswap *rzs = queue->queuedata;
+	struct bio_vec *bvec;
+	size_t index;
+	int i, rw, err = 0;
+
+	if (!valid_io_request(rzs, bio)) {
+		ramzswap_stat_inc(rzs, &rzs->stats.invalid_io);
+		bio_io_error(bio);
+		return 0;
+	}
+
+	if (bio_rw_flagged(bio, BIO_RW_DISCARD)) {
+		ramzswap_discard(rzs, bio);
+		bio_endio(bio, 0);
+		return 0;
+	}
+
+	rw = bio_data_dir(bio);
+	index = bio->bi_sector >> SECTORS_PER_PAGE_SHIFT;
+
+	bio_for_each_segment(bvec, bio, i) {
+		if (unlikely(bvec->bv_offset || bvec->bv_len != PAGE_SIZE)) {
+			ramzswap_stat_inc(rzs, &rzs->stats.invalid_io);
+			err = -EINVAL;
+			break;
+		}
+
+		if (rw == READ) {
+			ramzswap_stat_inc(rzs, &rzs->stats.num_reads);
+			err = ramzswap_read_page(rzs, bvec->bv_page, index);
+		} else {
+			ramzswap_stat_inc(rzs, &rzs->stats.num_writes);
+			err = ramzswap_write_page(rzs, bvec->bv_page, index);
+		}
+		if (err)
+			break;
+		index++;
+	}
+
+	if (!err)
+		set_bit(BIO_UPTODATE, &bio->bi_flags);
+	bio_endio(bio, err);
+	return 0;
+}
+
+/*
+ * Called by mm/swapfile.c, under swap_lock, when a swap slot on this
+ * device no longer holds any data.
+ */
+static void ramzswap_slot_free_notify(struct block_device *bdev,
+		unsigned long index)
+{
+	struct ramzswap *rzs = bdev->bd_disk->private_data;
+
+	spin_lock(&rzs->slot_lock);
+	if (index < (rzs->disksize >> PAGE_SHIFT)) {
+		ramzswap_free_slot(rzs, index);
+		rzs->stats.notify_free++;
+	}
+	spin_unlock(&rzs->slot_lock);
+}
+
+static const struct block_device_operations ramzswap_devops = {
+	.swap_slot_free_notify	= ramzswap_slot_free_notify,
+	.owner			= THIS_MODULE,
+};
+
+static size_t ramzswap_default_disksize(void)
+{
+	if (disksize_kb)
+		return PAGE_ALIGN((size_t)disksize_kb << 10);
+
+	return ((size_t)totalram_pages * RAMZSWAP_DEFAULT_DISKSIZE_PERC / 100)
+			<< PAGE_SHIFT;
+}
+
+/*
+ * (Re)allocate the slot table for the current disksize. Called with
+ * rzs->lock held and the device empty.
+ */
+static int ramzswap_alloc_table(struct ramzswap *rzs)
+{
+	size_t num_pages = rzs->disksize >> PAGE_SHIFT;
+
+	vfree(rzs->table);
+	rzs->table = vmalloc(num_pages * sizeof(*rzs->table));
+	if (!rzs->table) {
+		rzs->disksize = 0;
+		set_capacity(rzs->disk, 0);
+		return -ENOMEM;
+	}
+	memset(rzs->table, 0, num_pages * sizeof(*rzs->table));
+	set_capacity(rzs->disk, rzs->disksize >> SECTOR_SHIFT);
+
+	return 0;
+}
+
+/*
+ * Drop all stored pages. Called with rzs->lock held, when the device is
+ * not open.
+ */
+static void ramzswap_reset_device(struct ramzswap *rzs)
+{
+	size_t index;
+
+	for (index = 0; index < rzs->disksize >> PAGE_SHIFT; index++) {
+		spin_lock(&rzs->slot_lock);
+		ramzswap_free_slot(rzs, index);
+		spin_unlock(&rzs->slot_lock);
+		cond_resched();
+	}
+
+	memset(&rzs->stats, 0, sizeof(rzs->stats));
+}
+
+/* Returns non-zero if anyone has the block device open. */
+static int ramzswap_in_use(struct ramzswap *rzs)
+{
+	struct block_device *bdev;
+	int in_use;
+
+	bdev = bdget_disk(rzs->disk, 0);
+	if (!bdev)
+		return 0;
+	in_use = bdev->bd_openers;
+	if (!in_use)
+		invalidate_bdev(bdev);
+	bdput(bdev);
+
+	return in_use;
+}
+
+/* sysfs interface, in /sys/block/ramzswapN/ */
+
+static struct ramzswap *dev_to_rzs(struct device *dev)
+{
+	return dev_to_disk(dev)->private_data;
+}
+
+static ssize_t disksize_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%zu\n", dev_to_rzs(dev)->disksize);
+}
+
+static ssize_t disksize_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct ramzswap *rzs = dev_to_rzs(dev);
+	unsigned long long disksize;
+	int ret;
+
+	ret = strict_strtoull(buf, 10, &disksize);
+	if (ret)
+		return ret;
+
+	disksize = PAGE_ALIGN(disksize);
+	if (!disksize || disksize >> PAGE_SHIFT > totalram_pages * 2)
+		return -EINVAL;
+
+	mutex_lock(&rzs->lock);
+	if (ramzswap_in_use(rzs)) {
+		mutex_unlock(&rzs->lock);
+		return -EBUSY;
+	}
+
+	ramzswap_reset_device(rzs);
+	rzs->disksize = disksize;
+	ret = ramzswap_alloc_table(rzs);
+	mutex_unlock(&rzs->lock);
+
+	return ret ? ret : len;
+}
+
+static ssize_t reset_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct ramzswap *rzs = dev_to_rzs(dev);
+	unsigned long do_reset;
+	int ret;
+
+	ret = strict_strtoul(buf, 10, &do_reset);
+	if (ret)
+		return ret;
+	if (!do_reset)
+		return -EINVAL;
+
+	mutex_lock(&rzs->lock);
+	if (ramzswap_in_use(rzs)) {
+		mutex_unlock(&rzs->lock);
+		return -EBUSY;
+	}
+	ramzswap_reset_device(rzs);
+	mutex_unlock(&rzs->lock);
+
+	return len;
+}
+
+#define RAMZSWAP_STAT_SHOW(name, expr)					\
+static ssize_t name##_show(struct device *dev,				\
+		struct device_attribute *attr, char *buf)		\
+{									\
+	struct ramzswap *rzs = dev_to_rzs(dev);				\
+	u64 val;							\
+									\
+	spin_lock(&rzs->slot_lock);					\
+	val = (expr);							\
+	spin_unlock(&rzs->slot_lock);					\
+									\
+	return sprintf(buf, "%llu\n", (unsigned long long)val);		\
+}
+
+RAMZSWAP_STAT_SHOW(num_reads, rzs->stats.num_reads)
+RAMZSWAP_STAT_SHOW(num_writes, rzs->stats.num_writes)
+RAMZSWAP_STAT_SHOW(invalid_io, rzs->stats.invalid_io)
+RAMZSWAP_STAT_SHOW(notify_free, rzs->stats.notify_free)
+RAMZSWAP_STAT_SHOW(discard, rzs->stats.discard)
+RAMZSWAP_STAT_SHOW(zero_pages, rzs->stats.pages_zero)
+RAMZSWAP_STAT_SHOW(good_compress, rzs->stats.good_compress)
+RAMZSWAP_STAT_SHOW(pages_expand, rzs->stats.pages_expand)
+RAMZSWAP_STAT_SHOW(orig_data_size,
+	(u64)rzs->stats.pages_stored << PAGE_SHIFT)
+RAMZSWAP_STAT_SHOW(compr_data_size, rzs->stats.compr_size)
+
+/* Pool pages plus the pages holding incompressible data */
+static ssize_t mem_used_total_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ramzswap *rzs = dev_to_rzs(dev);
+	u64 pages;
+
+	spin_lock(&rzs->slot_lock);
+	pages = rzs->stats.pages_expand;
+	spin_unlock(&rzs->slot_lock);
+	pages += zobj_get_total_pages(rzs->mem_pool);
+
+	return sprintf(buf, "%llu\n", (unsigned long long)pages << PAGE_SHIFT);
+}
+
+static DEVICE_ATTR(disksize, S_IRUGO | S_IWUSR, disksize_show,
+		disksize_store);
+static DEVICE_ATTR(reset, S_IWUSR, NULL, reset_store);
+static DEVICE_ATTR(num_reads, S_IRUGO, num_reads_show, NULL);
+static DEVICE_ATTR(num_writes, S_IRUGO, num_writes_show, NULL);
+static DEVICE_ATTR(invalid_io, S_IRUGO, invalid_io_show, NULL);
+static DEVICE_ATTR(notify_free, S_IRUGO, notify_free_show, NULL);
+static DEVICE_ATTR(discard, S_IRUGO, discard_show, NULL);
+static DEVICE_ATTR(zero_pages, S_IRUGO, zero_pages_show, NULL);
+static DEVICE_ATTR(good_compress, S_IRUGO, good_compress_show, NULL);
+static DEVICE_ATTR(pages_expand, S_IRUGO, pages_expand_show, NULL);
+static DEVICE_ATTR(orig_data_size, S_IRUGO, orig_data_size_show, NULL);
+static DEVICE_ATTR(compr_data_size, S_IRUGO, compr_data_size_show, NULL);
+static DEVICE_ATTR(mem_used_total, S_IRUGO, mem_used_total_show, NULL);
+
+static struct attribute *ramzswap_disk_attrs[] = {
+	&dev_attr_disksize.attr,
+	&dev_attr_reset.attr,
+	&dev_attr_num_reads.attr,
+	&dev_attr_num_writes.attr,
+	&dev_attr_invalid_io.attr,
+	&dev_attr_notify_free.attr,
+	&dev_attr_discard.attr,
+	&dev_attr_zero_pages.attr,
+	&dev_attr_good_compress.attr,
+	&dev_attr_pages_expand.attr,
+	&dev_attr_orig_data_size.attr,
+	&dev_attr_compr_data_size.attr,
+	&dev_attr_mem_used_total.attr,
+	NULL,
+};
+
+static struct attribute_group ramzswap_disk_attr_group = {
+	.attrs = ramzswap_disk_attrs,
+};
+
+static int create_device(struct ramzswap *rzs, int device_id)
+{
+	int ret = -ENOMEM;
+
+	mutex_init(&rzs->lock);
+	spin_lock_init(&rzs->slot_lock);
+
+	rzs->mem_pool = zobj_create_pool();
+	if (!rzs->mem_pool)
+		goto out;
+
+	rzs->compress_workmem = kzalloc(LZO1X_MEM_COMPRESS, GFP_KERNEL);
+	/* lzo1x_1_compress may expand incompressible data a little */
+	rzs->compress_buffer = (void *)__get_free_pages(GFP_KERNEL, 1);
+	if (!rzs->compress_workmem || !rzs->compress_buffer)
+		goto out_free_buffers;
+
+	rzs->queue = blk_alloc_queue(GFP_KERNEL);
+	if (!rzs->queue)
+		goto out_free_buffers;
+
+	blk_queue_make_request(rzs->queue, ramzswap_make_request);
+	rzs->queue->queuedata = rzs;
+	blk_queue_logical_block_size(rzs->queue, PAGE_SIZE);
+	blk_queue_physical_block_size(rzs->queue, PAGE_SIZE);
+	blk_queue_io_min(rzs->queue, PAGE_SIZE);
+	blk_queue_max_discard_sectors(rzs->queue, UINT_MAX);
+	queue_flag_set_unlocked(QUEUE_FLAG_DISCARD, rzs->queue);
+	queue_flag_set_unlocked(QUEUE_FLAG_NONROT, rzs->queue);
+
+	rzs->disk = alloc_disk(1);
+	if (!rzs->disk)
+		goto out_free_queue;
+
+	rzs->disk->major = ramzswap_major;
+	rzs->disk->first_minor = device_id;
+	rzs->disk->fops = &ramzswap_devops;
+	rzs->disk->queue = rzs->queue;
+	rzs->disk->private_data = rzs;
+	snprintf(rzs->disk->disk_name, sizeof(rzs->disk->disk_name),
+		"ramzswap%d", device_id);
+
+	rzs->disksize = ramzswap_default_disksize();
+	ret = ramzswap_alloc_table(rzs);
+	if (ret)
+		goto out_put_disk;
+
+	add_disk(rzs->disk);
+
+	ret = sysfs_create_group(&disk_to_dev(rzs->disk)->kobj,
+			&ramzswap_disk_attr_group);
+	if (ret < 0) {
+		pr_warning("Error creating sysfs group for %s\n",
+			rzs->disk->disk_name);
+		ret = 0;
+	}
+
+	return 0;
+
+out_put_disk:
+	put_disk(rzs->disk);
+out_free_queue:
+	blk_cleanup_queue(rzs->queue);
+out_free_buffers:
+	free_pages((unsigned long)rzs->compress_buffer, 1);
+	kfree(rzs->compress_workmem);
+	zobj_destroy_pool(rzs->mem_pool);
+out:
+	return ret;
+}
+
+static void destroy_device(struct ramzswap *rzs)
+{
+	sysfs_remove_group(&disk_to_dev(rzs->disk)->kobj,
+			&ramzswap_disk_attr_group);
+	del_gendisk(rzs->disk);
+	put_disk(rzs->disk);
+	blk_cleanup_queue(rzs->queue);
+
+	ramzswap_reset_device(rzs);
+	vfree(rzs->table);
+
+	free_pages((unsigned long)rzs->compress_buffer, 1);
+	kfree(rzs->compress_workmem);
+	zobj_destroy_pool(rzs->mem_pool);
+}
+
+static int __init ramzswap_init(void)
+{
+	int ret, dev_id;
+
+	if (num_devices > 256) {
+		pr_err("Invalid value for num_devices: %u\n", num_devices);
+		return -EINVAL;
+	}
+
+	ramzswap_major = register_blkdev(0, "ramzswap");
+	if (ramzswap_major <= 0) {
+		pr_warning("Unable to get major number\n");
+		return -EBUSY;
+	}
+
+	if (!num_devices)
+		num_devices = 1;
+
+	devices = kzalloc(num_devices * sizeof(*devices), GFP_KERNEL);
+	if (!devices) {
+		ret = -ENOMEM;
+		goto out_unregister;
+	}
+
+	for (dev_id = 0; dev_id < num_devices; dev_id++) {
+		ret = create_device(&devices[dev_id], dev_id);
+		if (ret)
+			goto out_destroy;
+	}
+
+	pr_info("created %u device(s) of %zu KB each\n", num_devices,
+		devices[0].disksize >> 10);
+	return 0;
+
+out_destroy:
+	while (dev_id)
+		destroy_device(&devices[--dev_id]);
+	kfree(devices);
+out_unregister:
+	unregister_blkdev(ramzswap_major, "ramzswap");
+	return ret;
+}
+
+static void __exit ramzswap_exit(void)
+{
+	int i;
+
+	for (i = 0; i < num_devices; i++)
+		destroy_device(&devices[i]);
+
+	unregister_blkdev(ramzswap_major, "ramzswap");
+	kfree(devices);
+}
+
+module_param(num_devices, uint, 0);
+MODULE_PARM_DESC(num_devices, "Number of ramzswap devices");
+module_param(disksize_kb, ulong, 0);
+MODULE_PARM_DESC(disksize_kb, "Initial size of each device in KB "
+	"(default: 25% of RAM)");
+
+module_init(ramzswap_init);
+module_exit(ramzswap_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Compressed RAM Based Swap Device");
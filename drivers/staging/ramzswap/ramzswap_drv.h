@@ -0,0 +1,69 @@
+/*
+ * Compressed RAM based swap device
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef _RAMZSWAP_DRV_H_
+#define _RAMZSWAP_DRV_H_
+
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+
+#include "zobj_alloc.h"
+
+/* Default disk size as a percentage of RAM, if not set via sysfs */
+#define RAMZSWAP_DEFAULT_DISKSIZE_PERC	25
+
+#define SECTOR_SHIFT		9
+#define SECTORS_PER_PAGE_SHIFT	(PAGE_SHIFT - SECTOR_SHIFT)
+#define SECTORS_PER_PAGE	(1 << SECTORS_PER_PAGE_SHIFT)
+
+/* Flags for struct ramzswap_slot */
+#define RZS_ZERO		(1 << 0)	/* page is all zeroes */
+#define RZS_UNCOMPRESSED	(1 << 1)	/* page stored as is */
+
+/*
+ * One of these per page sized slot of the device. A slot which holds
+ * no data has neither a page nor any flag set.
+ */
+struct ramzswap_slot {
+	struct page *page;
+	u16 offset;
+	u16 size;
+	u8 flags;
+};
+
+struct ramzswap_stats {
+	u64 num_reads;
+	u64 num_writes;
+	u64 invalid_io;
+	u64 notify_free;
+	u64 discard;
+	u64 compr_size;		/* bytes used by compressed objects */
+	u32 pages_zero;
+	u32 pages_stored;	/* including zero and uncompressed pages */
+	u32 pages_expand;	/* stored uncompressed */
+	u32 good_compress;	/* compressed to at most half a page */
+};
+
+struct ramzswap {
+	struct zobj_pool *mem_pool;
+	void *compress_workmem;
+	void *compress_buffer;
+	struct ramzswap_slot *table;
+	size_t disksize;	/* bytes */
+
+	/* serializes use of the compression buffers, and resets */
+	struct mutex lock;
+	/* protects table and stats */
+	spinlock_t slot_lock;
+
+	struct request_queue *queue;
+	struct gendisk *disk;
+	struct ramzswap_stats stats;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * Size-class allocator for compressed objects
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Compressed pages come in all sizes between a few bytes and a page,
+ * which fragments kmalloc's power-of-two caches badly. Instead each
+ * page backing this pool belongs to a single size class (a multiple of
+ * ZOBJ_ALIGN bytes) and is cut into equal objects. Objects are named by
+ * <page, offset> rather than a pointer, so the pages may come from
+ * highmem and are only mapped while being accessed.
+ *
+ * Per-page state lives in struct page itself:
+ *   page->lru     - link in the class's list of partially used pages
+ *   page->private - number of objects in use
+ *   page->index   - offset of the first free object, or ZOBJ_NONE
+ * and each free object starts with the u16 offset of the next one.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/highmem.h>
+
+#include "zobj_alloc.h"
+
+#define ZOBJ_NR_CLASSES	(ZOBJ_MAX_SIZE >> ZOBJ_ALIGN_SHIFT)
+#define ZOBJ_NONE	PAGE_SIZE
+
+struct zobj_class {
+	struct list_head partial;
+	unsigned int size;
+};
+
+struct zobj_pool {
+	spinlock_t lock;
+	u64 total_pages;
+	struct zobj_class class[ZOBJ_NR_CLASSES];
+};
+
+static inline int zobj_class_index(size_t size)
+{
+	return (size - 1) >> ZOBJ_ALIGN_SHIFT;
+}
+
+static inline u16 *zobj_link(void *base, unsigned long offset)
+{
+	return (u16 *)((char *)base + offset);
+}
+
+/*
+ * Prepare a fresh page for the given class: thread every object onto
+ * the page's free list.
+ */
+static void zobj_init_page(struct page *page, unsigned int size)
+{
+	unsigned long off;
+	void *base;
+
+	base = kmap_atomic(page, KM_USER0);
+	for (off = 0; off + size <= PAGE_SIZE; off += size) {
+		if (off + 2 * size <= PAGE_SIZE)
+			*zobj_link(base, off) = off + size;
+		else
+			*zobj_link(base, off) = ZOBJ_NONE;
+	}
+	kunmap_atomic(base, KM_USER0);
+
+	INIT_LIST_HEAD(&page->lru);
+	set_page_private(page, 0);
+	page->index = 0;
+}
+
+/**
+ * zobj_malloc - allocate an object of at least size bytes
+ * @pool: pool to allocate from
+ * @size: requested size, at most ZOBJ_MAX_SIZE
+ * @page: returns the page holding the object
+ * @offset: returns the offset of the object within @page
+ * @flags: allocation flags for when a new page is needed
+ *
+ * Returns 0 on success or -ENOMEM.
+ */
+int zobj_malloc(struct zobj_pool *pool, size_t size, struct page **page,
+		u16 *offset, gfp_t flags)
+{
+	struct zobj_class *class;
+	struct page *p;
+	void *base;
+
+	if (unlikely(!size || size > ZOBJ_MAX_SIZE))
+		return -EINVAL;
+
+	class = &pool->class[zobj_class_index(size)];
+
+	spin_lock(&pool->lock);
+	if (list_empty(&class->partial)) {
+		spin_unlock(&pool->lock);
+
+		p = alloc_page(flags);
+		if (!p)
+			return -ENOMEM;
+		zobj_init_page(p, class->size);
+
+		spin_lock(&pool->lock);
+		list_add(&p->lru, &class->partial);
+		pool->total_pages++;
+	}
+
+	p = list_first_entry(&class->partial, struct page, lru);
+	*page = p;
+	*offset = p->index;
+
+	base = kmap_atomic(p, KM_USER0);
+	p->index = *zobj_link(base, *offset);
+	kunmap_atomic(base, KM_USER0);
+
+	set_page_private(p, page_private(p) + 1);
+	if (p->index == ZOBJ_NONE)
+		list_del_init(&p->lru);
+	spin_unlock(&pool->lock);
+
+	return 0;
+}
+
+/**
+ * zobj_free - free an object returned by zobj_malloc
+ * @pool: pool the object was allocated from
+ * @size: size that was passed to zobj_malloc
+ * @page: page holding the object
+ * @offset: offset of the object within @page
+ *
+ * Does not sleep, so may be called with spinlocks held.
+ */
+void zobj_free(struct zobj_pool *pool, size_t size, struct page *page,
+		u16 offset)
+{
+	struct zobj_class *class = &pool->class[zobj_class_index(size)];
+	int was_full;
+	void *base;
+
+	spin_lock(&pool->lock);
+	was_full = page->index == ZOBJ_NONE;
+
+	base = kmap_atomic(page, KM_USER0);
+	*zobj_link(base, offset) = page->index;
+	kunmap_atomic(base, KM_USER0);
+	page->index = offset;
+
+	set_page_private(page, page_private(page) - 1);
+	if (!page_private(page)) {
+		if (!was_full)
+			list_del(&page->lru);
+		pool->total_pages--;
+		spin_unlock(&pool->lock);
+		page->index = 0;
+		__free_page(page);
+		return;
+	}
+
+	if (was_full)
+		list_add(&page->lru, &class->partial);
+	spin_unlock(&pool->lock);
+}
+
+u64 zobj_get_total_pages(struct zobj_pool *pool)
+{
+	u64 pages;
+
+	spin_lock(&pool->lock);
+	pages = pool->total_pages;
+	spin_unlock(&pool->lock);
+
+	return pages;
+}
+
+struct zobj_pool *zobj_create_pool(void)
+{
+	struct zobj_pool *pool;
+	int i;
+
+	pool = kzalloc(sizeof(*pool), GFP_KERNEL);
+	if (!pool)
+		return NULL;
+
+	spin_lock_init(&pool->lock);
+	for (i = 0; i < ZOBJ_NR_CLASSES; i++) {
+		INIT_LIST_HEAD(&pool->class[i].partial);
+		pool->class[i].size = (i + 1) << ZOBJ_ALIGN_SHIFT;
+	}
+
+	return pool;
+}
+
+/*
+ * All objects must have been freed already; pages still in use at this
+ * point are leaked rather than freed under someone's feet.
+ */
+void zobj_destroy_pool(struct zobj_pool *pool)
+{
+	WARN_ON(pool->total_pages);
+	kfree(pool);
+}
@@ -0,0 +1,38 @@
+/*
+ * Size-class allocator for compressed objects
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef _ZOBJ_ALLOC_H_
+#define _ZOBJ_ALLOC_H_
+
+#include <linux/types.h>
+#include <linux/mm.h>
+
+/*
+ * Objects are rounded up to a multiple of ZOBJ_ALIGN bytes and carved
+ * out of whole pages, one size class per page. An object larger than
+ * half a page gets a page to itself, saving nothing over the
+ * uncompressed page, so ZOBJ_MAX_SIZE is PAGE_SIZE / 2: larger objects
+ * should be stored as a page of their own by the caller.
+ */
+#define ZOBJ_ALIGN_SHIFT	5
+#define ZOBJ_ALIGN		(1 << ZOBJ_ALIGN_SHIFT)
+#define ZOBJ_MAX_SIZE		(PAGE_SIZE / 2)
+
+struct zobj_pool;
+
+struct zobj_pool *zobj_create_pool(void);
+void zobj_destroy_pool(struct zobj_pool *pool);
+
+int zobj_malloc(struct zobj_pool *pool, size_t size, struct page **page,
+		u16 *offset, gfp_t flags);
+void zobj_free(struct zobj_pool *pool, size_t size, struct page *page,
+		u16 offset);
+
+u64 zobj_get_total_pages(struct zobj_pool *pool);
+
+#endif
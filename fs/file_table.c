@@ -284,6 +284,7 @@ void __fput(struct file *file)
 	if (unlikely(S_ISCHR(inode->i_mode) && inode->i_cdev != NULL))
 		cdev_put(inode->i_cdev);
 	fops_put(file->f_op);
+	ra_trace_release(file);
 	put_pid(file->f_owner.pid);
 	file_kill(file);
 	if (file->f_mode & FMODE_WRITE)
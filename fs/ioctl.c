@@ -450,6 +450,10 @@ static int file_ioctl(struct file *filp, unsigned int cmd,
 	case FS_IOC_RESVSP:
 	case FS_IOC_RESVSP64:
 		return ioctl_preallocate(filp, p);
+	case FS_IOC_RATRACE_GET:
+		return ra_trace_get(filp, (struct ra_trace __user *)arg);
+	case FS_IOC_RATRACE_REPLAY:
+		return ra_trace_replay(filp, (struct ra_trace __user *)arg);
 	}
 
 	return vfs_ioctl(filp, cmd, arg);
@@ -223,6 +223,7 @@ retry:
 				       (unsigned long long)newkey);
 
 		spin_lock_irq(&btnc->tree_lock);
+		nilfs_drop_shadow_entry(btnc, newkey);
 		err = radix_tree_insert(&btnc->page_tree, newkey, obh->b_page);
 		spin_unlock_irq(&btnc->tree_lock);
 		/*
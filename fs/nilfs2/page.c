@@ -434,6 +434,7 @@ repeat:
 			spin_unlock_irq(&smap->tree_lock);
 
 			spin_lock_irq(&dmap->tree_lock);
+			nilfs_drop_shadow_entry(dmap, offset);
 			err = radix_tree_insert(&dmap->page_tree, offset, page);
 			if (unlikely(err < 0)) {
 				WARN_ON(err == -EEXIST);
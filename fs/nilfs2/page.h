@@ -62,6 +62,22 @@ unsigned nilfs_page_count_clean_buffers(struct page *, unsigned, unsigned);
 #define NILFS_PAGE_BUG(page, m, a...) \
 	do { nilfs_page_bug(page); BUG(); } while (0)
 
+/*
+ * Pages are moved between caches with radix_tree_insert(), which fails
+ * if reclaim left the shadow entry of an evicted page in the slot (see
+ * mm/workingset.c).  Must be called with the tree_lock held.
+ */
+static inline void
+nilfs_drop_shadow_entry(struct address_space *mapping, pgoff_t index)
+{
+	void *entry = radix_tree_lookup(&mapping->page_tree, index);
+
+	if (entry && radix_tree_exceptional_entry(entry)) {
+		radix_tree_delete(&mapping->page_tree, index);
+		mapping->nrshadows--;
+	}
+}
+
 static inline struct buffer_head *
 nilfs_page_get_nth_block(struct page *page, unsigned int count)
 {
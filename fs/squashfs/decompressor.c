@@ -0,0 +1,130 @@
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * Copyright (c) 2002, 2003, 2004, 2005, 2006, 2007, 2008
+ * Phillip Lougher <phillip@lougher.demon.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * decompressor.c
+ */
+
+/*
+ * This file maps the compression type stored in the superblock to the
+ * decompressor implementing it, and has helpers shared by decompressors
+ * that can only work on contiguous input and output buffers.
+ */
+
+#include <linux/types.h>
+#include <linux/mutex.h>
+#include <linux/string.h>
+#include <linux/buffer_head.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs_fs_i.h"
+#include "decompressor.h"
+#include "squashfs.h"
+
+/*
+ * This table is ordered by compression id.  Compression types that are
+ * known but not built into this kernel have supported == 0, so a
+ * sensible error can be given at mount time.
+ */
+#ifndef CONFIG_SQUASHFS_LZMA
+static const struct squashfs_decompressor squashfs_lzma_comp_ops = {
+	NULL, NULL, NULL, LZMA_COMPRESSION, "lzma", 0
+};
+#endif
+
+#ifndef CONFIG_SQUASHFS_LZO
+static const struct squashfs_decompressor squashfs_lzo_comp_ops = {
+	NULL, NULL, NULL, LZO_COMPRESSION, "lzo", 0
+};
+#endif
+
+static const struct squashfs_decompressor squashfs_unknown_comp_ops = {
+	NULL, NULL, NULL, 0, "unknown", 0
+};
+
+static const struct squashfs_decompressor *decompressor[] = {
+	&squashfs_zlib_comp_ops,
+	&squashfs_lzma_comp_ops,
+	&squashfs_lzo_comp_ops,
+	&squashfs_unknown_comp_ops
+};
+
+
+const struct squashfs_decompressor *squashfs_lookup_decompressor(int id)
+{
+	int i;
+
+	for (i = 0; decompressor[i]->id; i++)
+		if (id == decompressor[i]->id)
+			break;
+
+	return decompressor[i];
+}
+
+
+/*
+ * Copy length bytes of a compressed block, starting offset bytes into
+ * the first buffer_head, into the contiguous buffer buff.  All of the
+ * buffer_heads are released.
+ */
+int squashfs_bh_to_buffer(struct squashfs_sb_info *msblk, void *buff,
+	struct buffer_head **bh, int b, int offset, int length)
+{
+	int i, avail, bytes = length;
+
+	for (i = 0; i < b; i++) {
+		wait_on_buffer(bh[i]);
+		if (!buffer_uptodate(bh[i]))
+			goto block_release;
+
+		avail = min(bytes, msblk->devblksize - offset);
+		memcpy(buff, bh[i]->b_data + offset, avail);
+		buff += avail;
+		bytes -= avail;
+		offset = 0;
+		put_bh(bh[i]);
+	}
+
+	return 0;
+
+block_release:
+	for (; i < b; i++)
+		put_bh(bh[i]);
+
+	return -EIO;
+}
+
+
+/*
+ * Copy length bytes of decompressed data from the contiguous buffer buff
+ * into the PAGE_CACHE_SIZE output buffers.
+ */
+void squashfs_buffer_to_pages(void **buffer, void *buff, int length,
+	int pages)
+{
+	int page, avail;
+
+	for (page = 0; length > 0 && page < pages; page++) {
+		avail = min_t(int, length, PAGE_CACHE_SIZE);
+		memcpy(buffer[page], buff, avail);
+		buff += avail;
+		length -= avail;
+	}
+}
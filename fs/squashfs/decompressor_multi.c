@@ -0,0 +1,213 @@
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * Copyright (c) 2002, 2003, 2004, 2005, 2006, 2007, 2008
+ * Phillip Lougher <phillip@lougher.demon.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * decompressor_multi.c
+ */
+
+/*
+ * This file implements a pool of decompressor streams, so that blocks
+ * can be decompressed in parallel on SMP systems.  One stream is
+ * allocated at mount time; further streams are allocated on demand, up
+ * to one per possible CPU, and are kept until unmount.  If all streams
+ * are busy and no more may be allocated, readers wait for one to become
+ * idle.
+ */
+
+#include <linux/fs.h>
+#include <linux/vfs.h>
+#include <linux/slab.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/sched.h>
+#include <linux/wait.h>
+#include <linux/cpumask.h>
+#include <linux/buffer_head.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs_fs_i.h"
+#include "decompressor.h"
+#include "squashfs.h"
+
+struct squashfs_stream_pool {
+	struct list_head	idle;
+	spinlock_t		lock;
+	int			streams;
+	int			max_streams;
+	wait_queue_head_t	wait;
+};
+
+
+static struct squashfs_stream *squashfs_stream_alloc(
+	struct squashfs_sb_info *msblk)
+{
+	struct squashfs_stream *stream;
+
+	stream = kzalloc(sizeof(*stream), GFP_KERNEL);
+	if (stream == NULL)
+		return NULL;
+
+	stream->stream = squashfs_decompressor_init(msblk);
+	if (stream->stream == NULL) {
+		kfree(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+
+static void squashfs_stream_free(struct squashfs_sb_info *msblk,
+	struct squashfs_stream *stream)
+{
+	squashfs_decompressor_free(msblk, stream->stream);
+	kfree(stream);
+}
+
+
+int squashfs_max_streams(void)
+{
+	return num_possible_cpus();
+}
+
+
+int squashfs_stream_pool_init(struct squashfs_sb_info *msblk)
+{
+	struct squashfs_stream_pool *pool;
+	struct squashfs_stream *stream;
+
+	pool = kzalloc(sizeof(*pool), GFP_KERNEL);
+	if (pool == NULL)
+		return -ENOMEM;
+
+	INIT_LIST_HEAD(&pool->idle);
+	spin_lock_init(&pool->lock);
+	init_waitqueue_head(&pool->wait);
+	pool->max_streams = squashfs_max_streams();
+
+	/*
+	 * Always have one stream, so readers can fall back to waiting
+	 * for it if allocating more streams fails later.
+	 */
+	stream = squashfs_stream_alloc(msblk);
+	if (stream == NULL) {
+		kfree(pool);
+		return -ENOMEM;
+	}
+	list_add(&stream->list, &pool->idle);
+	pool->streams = 1;
+
+	msblk->stream_pool = pool;
+	return 0;
+}
+
+
+void squashfs_stream_pool_destroy(struct squashfs_sb_info *msblk)
+{
+	struct squashfs_stream_pool *pool = msblk->stream_pool;
+	struct squashfs_stream *stream;
+
+	if (pool == NULL)
+		return;
+
+	while (!list_empty(&pool->idle)) {
+		stream = list_entry(pool->idle.next, struct squashfs_stream,
+			list);
+		list_del(&stream->list);
+		squashfs_stream_free(msblk, stream);
+		pool->streams--;
+	}
+
+	WARN_ON(pool->streams);
+	kfree(pool);
+	msblk->stream_pool = NULL;
+}
+
+
+/*
+ * Get an idle decompressor stream, allocating a new one if the pool has
+ * not yet reached its limit, otherwise waiting for one to be released.
+ */
+static struct squashfs_stream *squashfs_get_stream(
+	struct squashfs_sb_info *msblk)
+{
+	struct squashfs_stream_pool *pool = msblk->stream_pool;
+	struct squashfs_stream *stream;
+
+	while (1) {
+		spin_lock(&pool->lock);
+		if (!list_empty(&pool->idle)) {
+			stream = list_entry(pool->idle.next,
+				struct squashfs_stream, list);
+			list_del(&stream->list);
+			spin_unlock(&pool->lock);
+			return stream;
+		}
+
+		if (pool->streams >= pool->max_streams) {
+			spin_unlock(&pool->lock);
+			wait_event(pool->wait, !list_empty(&pool->idle));
+			continue;
+		}
+
+		pool->streams++;
+		spin_unlock(&pool->lock);
+
+		stream = squashfs_stream_alloc(msblk);
+		if (stream)
+			return stream;
+
+		/*
+		 * Out of memory, stop growing the pool and wait for one
+		 * of the existing streams instead.
+		 */
+		spin_lock(&pool->lock);
+		pool->streams--;
+		pool->max_streams = pool->streams;
+		spin_unlock(&pool->lock);
+	}
+}
+
+
+static void squashfs_put_stream(struct squashfs_sb_info *msblk,
+	struct squashfs_stream *stream)
+{
+	struct squashfs_stream_pool *pool = msblk->stream_pool;
+
+	spin_lock(&pool->lock);
+	list_add(&stream->list, &pool->idle);
+	spin_unlock(&pool->lock);
+	wake_up(&pool->wait);
+}
+
+
+int squashfs_decompress(struct squashfs_sb_info *msblk, void **buffer,
+	struct buffer_head **bh, int b, int offset, int length, int srclength,
+	int pages)
+{
+	struct squashfs_stream *stream = squashfs_get_stream(msblk);
+	int res;
+
+	res = msblk->decompressor->decompress(msblk, stream->stream, buffer,
+		bh, b, offset, length, srclength, pages);
+	squashfs_put_stream(msblk, stream);
+
+	return res;
+}
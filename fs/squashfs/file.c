@@ -411,8 +411,16 @@ static int squashfs_readpage(struct file *file, struct page *page)
 			sparse = 1;
 		} else {
 			/*
-			 * Read and decompress datablock.
+			 * Decompress datablock straight into the page cache.
+			 * Only if there's no memory for that fall back to
+			 * reading it through the read_page cache.
 			 */
+			int res = squashfs_readpage_block(page, block, bsize);
+			if (res == 0)
+				return 0;
+			if (res != -ENOMEM)
+				goto error_out;
+
 			buffer = squashfs_get_datablock(inode->i_sb,
 								block, bsize);
 			if (buffer->error) {
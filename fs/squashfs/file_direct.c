@@ -0,0 +1,174 @@
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * Copyright (c) 2002, 2003, 2004, 2005, 2006, 2007, 2008
+ * Phillip Lougher <phillip@lougher.demon.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * file_direct.c
+ */
+
+/*
+ * This file implements reading a datablock by decompressing it directly
+ * into the page cache pages that cover it, rather than into the
+ * read_page cache and copying from there.
+ *
+ * All pages of the block that can be grabbed without blocking are
+ * filled in.  Pages that are already up to date, or that are locked by
+ * someone else, are decompressed into a scratch page and discarded.
+ *
+ * The decompressors may sleep and write to the whole block, so the
+ * output pages must stay addressable until they are done.  Lowmem pages
+ * are written through their permanent mapping.  Keeping up to a block's
+ * worth of highmem pages kmapped at once could exhaust the kmap pool, so
+ * those are decompressed into a lowmem bounce page each and copied over
+ * afterwards, one kmap_atomic at a time.
+ */
+
+#include <linux/fs.h>
+#include <linux/vfs.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/pagemap.h>
+#include <linux/highmem.h>
+#include <linux/zlib.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs_fs_i.h"
+#include "squashfs.h"
+
+/*
+ * Read and decompress the datablock at block (compressed size bsize)
+ * which covers target_page.  On success the target page and any
+ * neighbouring pages filled in are marked up to date and unlocked.
+ * On failure the target page is left locked for the caller to deal
+ * with.  Returns -ENOMEM if the page arrays could not be allocated, in
+ * which case the caller should fall back to the read_page cache.
+ */
+int squashfs_readpage_block(struct page *target_page, u64 block, int bsize)
+{
+	struct inode *inode = target_page->mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int file_end = (i_size_read(inode) - 1) >> PAGE_CACHE_SHIFT;
+	int mask = (1 << (msblk->block_log - PAGE_CACHE_SHIFT)) - 1;
+	int start_index = target_page->index & ~mask;
+	int end_index = min(start_index | mask, file_end);
+	int pages = end_index - start_index + 1;
+	int i, n, avail, bytes, res = -ENOMEM;
+	struct page **page, **bounce;
+	void **pageaddr;
+	struct page *scratch = NULL;
+	void *addr;
+
+	page = kmalloc(pages * sizeof(*page), GFP_KERNEL);
+	bounce = kcalloc(pages, sizeof(*bounce), GFP_KERNEL);
+	pageaddr = kmalloc(pages * sizeof(*pageaddr), GFP_KERNEL);
+	if (page == NULL || bounce == NULL || pageaddr == NULL)
+		goto out;
+
+	/*
+	 * Grab the other pages of the block from the page cache, without
+	 * blocking.  Any we can't get, or which are already up to date,
+	 * are replaced by a shared scratch page.
+	 */
+	for (i = 0, n = start_index; n <= end_index; i++, n++) {
+		if (n == target_page->index)
+			page[i] = target_page;
+		else {
+			page[i] = grab_cache_page_nowait(target_page->mapping,
+				n);
+			if (page[i] && PageUptodate(page[i])) {
+				unlock_page(page[i]);
+				page_cache_release(page[i]);
+				page[i] = NULL;
+			}
+		}
+
+		if (page[i] == NULL) {
+			if (scratch == NULL) {
+				scratch = alloc_page(GFP_KERNEL);
+				if (scratch == NULL)
+					goto release_pages;
+			}
+			pageaddr[i] = page_address(scratch);
+		} else if (PageHighMem(page[i])) {
+			bounce[i] = alloc_page(GFP_KERNEL);
+			if (bounce[i] == NULL) {
+				i++;
+				goto release_pages;
+			}
+			pageaddr[i] = page_address(bounce[i]);
+		} else
+			pageaddr[i] = page_address(page[i]);
+	}
+
+	res = squashfs_read_data(inode->i_sb, pageaddr, block, bsize, NULL,
+		msblk->block_size, pages);
+	if (res < 0)
+		goto release_pages;
+
+	/*
+	 * Copy out the bounced pages, zero the part of the last page not
+	 * covered by the block, and mark the pages up to date.
+	 */
+	for (i = 0, bytes = res; i < pages; i++, bytes -= PAGE_CACHE_SIZE) {
+		if (page[i] == NULL)
+			continue;
+
+		avail = max(0, min_t(int, bytes, PAGE_CACHE_SIZE));
+		addr = bounce[i] ? kmap_atomic(page[i], KM_USER0) :
+			pageaddr[i];
+		if (bounce[i])
+			memcpy(addr, pageaddr[i], avail);
+		if (avail < PAGE_CACHE_SIZE)
+			memset(addr + avail, 0, PAGE_CACHE_SIZE - avail);
+		if (bounce[i])
+			kunmap_atomic(addr, KM_USER0);
+		flush_dcache_page(page[i]);
+		SetPageUptodate(page[i]);
+		unlock_page(page[i]);
+		if (page[i] != target_page)
+			page_cache_release(page[i]);
+	}
+
+	res = 0;
+	goto out;
+
+release_pages:
+	/* i is the number of pages grabbed so far */
+	while (i--) {
+		if (page[i] == NULL)
+			continue;
+
+		if (page[i] != target_page) {
+			unlock_page(page[i]);
+			page_cache_release(page[i]);
+		}
+	}
+
+out:
+	for (i = 0; bounce && i < pages; i++)
+		if (bounce[i])
+			__free_page(bounce[i]);
+	if (scratch)
+		__free_page(scratch);
+	kfree(pageaddr);
+	kfree(bounce);
+	kfree(page);
+	return res;
+}
@@ -0,0 +1,167 @@
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * Copyright (c) 2002, 2003, 2004, 2005, 2006, 2007, 2008
+ * Phillip Lougher <phillip@lougher.demon.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * lzma_wrapper.c
+ */
+
+/*
+ * LZMA blocks are stored in "lzma alone" format: a 13 byte header
+ * (properties, dictionary size and 64-bit little-endian uncompressed
+ * size) followed by the compressed data.  Blocks are decompressed with
+ * lib/decompress_unlzma.c from a contiguous input buffer into a
+ * contiguous output buffer.  The probabilities live in a per-stream
+ * workspace, sized for the lc + lp used by mksquashfs (lc=3, lp=0) with
+ * some room to spare; blocks needing more are rejected as corrupt.
+ */
+
+#include <linux/mutex.h>
+#include <linux/buffer_head.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/decompress/unlzma.h>
+#include <asm/unaligned.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs_fs_i.h"
+#include "squashfs.h"
+#include "decompressor.h"
+
+#define LZMA_HEADER_SIZE	13
+#define LZMA_HEADER_DST_SIZE	5
+#define LZMA_MAX_LCLP		4
+#define LZMA_WORKSPACE_SIZE	UNLZMA_WORKSPACE_SIZE(LZMA_MAX_LCLP)
+
+struct squashfs_lzma {
+	void	*input;
+	void	*output;
+	void	*workspace;
+};
+
+static void *lzma_init(struct squashfs_sb_info *msblk)
+{
+	int block_size = max_t(int, msblk->block_size, SQUASHFS_METADATA_SIZE);
+
+	struct squashfs_lzma *stream = kzalloc(sizeof(*stream), GFP_KERNEL);
+	if (stream == NULL)
+		goto failed;
+	stream->input = vmalloc(block_size);
+	if (stream->input == NULL)
+		goto failed;
+	stream->output = vmalloc(block_size);
+	if (stream->output == NULL)
+		goto failed2;
+	stream->workspace = vmalloc(LZMA_WORKSPACE_SIZE);
+	if (stream->workspace == NULL)
+		goto failed3;
+
+	return stream;
+
+failed3:
+	vfree(stream->output);
+failed2:
+	vfree(stream->input);
+failed:
+	ERROR("Failed to allocate lzma workspace\n");
+	kfree(stream);
+	return NULL;
+}
+
+
+static void lzma_free(void *strm)
+{
+	struct squashfs_lzma *stream = strm;
+
+	if (stream) {
+		vfree(stream->input);
+		vfree(stream->output);
+		vfree(stream->workspace);
+	}
+	kfree(stream);
+}
+
+
+static void lzma_error(char *x)
+{
+	ERROR("unlzma error: %s\n", x);
+}
+
+
+static int lzma_uncompress(struct squashfs_sb_info *msblk, void *strm,
+	void **buffer, struct buffer_head **bh, int b, int offset, int length,
+	int srclength, int pages)
+{
+	struct squashfs_lzma *stream = strm;
+	int out_max = min_t(int, pages * PAGE_CACHE_SIZE,
+		max_t(int, msblk->block_size, SQUASHFS_METADATA_SIZE));
+	unsigned char *hdr = stream->input;
+	u64 dst_size;
+	int res, pos = 0;
+
+	if (length < LZMA_HEADER_SIZE) {
+		ERROR("lzma block too short, data probably corrupt\n");
+		goto release_buffers;
+	}
+
+	if (squashfs_bh_to_buffer(msblk, stream->input, bh, b, offset,
+			length))
+		return -EIO;
+
+	/*
+	 * unlzma() writes the output buffer up to the size given in the
+	 * header without further checking, so validate it first.
+	 */
+	dst_size = get_unaligned_le64(hdr + LZMA_HEADER_DST_SIZE);
+	if (dst_size > out_max) {
+		ERROR("lzma uncompressed size %llu too large, data probably "
+			"corrupt\n", (unsigned long long) dst_size);
+		return -EIO;
+	}
+
+	/*
+	 * unlzma() stops and fails on truncated input and on match distances
+	 * reaching before the start of the output.  lzma_error() only logs
+	 * the reason.
+	 */
+	res = unlzma_workspace(stream->input, length, stream->output, &pos,
+		lzma_error, stream->workspace, LZMA_WORKSPACE_SIZE);
+	if (res || pos > length) {
+		ERROR("lzma decompression failed, data probably corrupt\n");
+		return -EIO;
+	}
+
+	squashfs_buffer_to_pages(buffer, stream->output, dst_size, pages);
+	return dst_size;
+
+release_buffers:
+	while (b--)
+		put_bh(bh[b]);
+
+	return -EIO;
+}
+
+const struct squashfs_decompressor squashfs_lzma_comp_ops = {
+	.init = lzma_init,
+	.free = lzma_free,
+	.decompress = lzma_uncompress,
+	.id = LZMA_COMPRESSION,
+	.name = "lzma",
+	.supported = 1
+};
@@ -51,7 +51,15 @@ struct squashfs_cache_entry {
 	void			**data;
 };
 
+struct squashfs_stream {
+	void			*stream;
+	struct list_head	list;
+};
+
+struct squashfs_stream_pool;
+
 struct squashfs_sb_info {
+	const struct squashfs_decompressor *decompressor;
 	int			devblksize;
 	int			devblksize_log2;
 	struct squashfs_cache	*block_cache;
@@ -61,10 +69,9 @@ struct squashfs_sb_info {
 	__le64			*id_table;
 	__le64			*fragment_index;
 	unsigned int		*fragment_index_2;
-	struct mutex		read_data_mutex;
 	struct mutex		meta_index_mutex;
 	struct meta_index	*meta_index;
-	z_stream		stream;
+	struct squashfs_stream_pool *stream_pool;
 	__le64			*inode_lookup_table;
 	u64			inode_table;
 	u64			directory_table;
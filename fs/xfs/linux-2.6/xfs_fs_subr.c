@@ -37,7 +37,7 @@ xfs_tosspages(
 {
 	struct address_space *mapping = VFS_I(ip)->i_mapping;
 
-	if (mapping->nrpages)
+	if (mapping->nrpages || mapping->nrshadows)
 		truncate_inode_pages(mapping, first);
 }
 
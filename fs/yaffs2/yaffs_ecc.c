@@ -76,9 +76,8 @@ static int yaffs_CountBits(unsigned char x)
 {
 	int r = 0;
 	while (x) {
-		if (x & 1)
-			r++;
-		x >>= 1;
+		x &= x - 1;
+		r++;
 	}
 	return r;
 }
@@ -87,33 +86,19 @@ static int yaffs_CountBits32(unsigned x)
 {
 	int r = 0;
 	while (x) {
-		if (x & 1)
-			r++;
-		x >>= 1;
+		x &= x - 1;
+		r++;
 	}
 	return r;
 }
 
-/* Calculate the ECC for a 256-byte block of data */
-void yaffs_ECCCalculate(const unsigned char *data, unsigned char *ecc)
+/* Pack the line parities into the three ECC bytes */
+static void yaffs_ECCPack(unsigned char col_parity,
+			  unsigned char line_parity,
+			  unsigned char line_parity_prime,
+			  unsigned char *ecc)
 {
-	unsigned int i;
-
-	unsigned char col_parity = 0;
-	unsigned char line_parity = 0;
-	unsigned char line_parity_prime = 0;
 	unsigned char t;
-	unsigned char b;
-
-	for (i = 0; i < 256; i++) {
-		b = column_parity_table[*data++];
-		col_parity ^= b;
-
-		if (b & 0x01) {		/* odd number of bits in the byte */
-			line_parity ^= i;
-			line_parity_prime ^= ~i;
-		}
-	}
 
 	ecc[2] = (~col_parity) | 0x03;
 
@@ -163,6 +148,113 @@ void yaffs_ECCCalculate(const unsigned char *data, unsigned char *ecc)
 #endif
 }
 
+/* Calculate the ECC for a 256-byte block of data, one byte at a time */
+static void yaffs_ECCCalculateBytewise(const unsigned char *data,
+				       unsigned char *ecc)
+{
+	unsigned int i;
+
+	unsigned char col_parity = 0;
+	unsigned char line_parity = 0;
+	unsigned char line_parity_prime = 0;
+	unsigned char b;
+
+	for (i = 0; i < 256; i++) {
+		b = column_parity_table[*data++];
+		col_parity ^= b;
+
+		if (b & 0x01) {		/* odd number of bits in the byte */
+			line_parity ^= i;
+			line_parity_prime ^= ~i;
+		}
+	}
+
+	yaffs_ECCPack(col_parity, line_parity, line_parity_prime, ecc);
+}
+
+/* Parity of a 32-bit word: 1 if an odd number of bits are set */
+static Y_INLINE int yaffs_Parity32(__u32 x)
+{
+	x ^= x >> 16;
+	x ^= x >> 8;
+	return column_parity_table[x & 0xff] & 0x01;
+}
+
+/*
+ * Calculate the ECC for a 256-byte block of data.
+ *
+ * All parities are linear in the data, so instead of looking up every
+ * byte we XOR the block together 32 bits at a time:
+ *  - the column parity is the table entry for the XOR of all bytes;
+ *  - line parity bit n (n >= 2) is the parity of every word whose word
+ *    index has bit n-2 set;
+ *  - line parity bits 0 and 1 select bytes within a word, so they come
+ *    from the parity of bytes 1^3 and 2^3 of the XOR of all words.
+ * The prime parities are the plain ones inverted when the block holds
+ * an odd number of set bits.
+ */
+void yaffs_ECCCalculate(const unsigned char *data, unsigned char *ecc)
+{
+	const __u32 *wp = (const __u32 *)data;
+	__u32 all = 0;
+	__u32 w0, w1, w2, w3, t;
+	__u32 odd1 = 0, odd2 = 0;
+	__u32 p4 = 0, p8 = 0, p16 = 0, p32 = 0;
+	const unsigned char *ab = (const unsigned char *)&all;
+	unsigned char col_parity;
+	unsigned char line_parity;
+	unsigned int i;
+
+	if (((unsigned long)data) & 3) {
+		yaffs_ECCCalculateBytewise(data, ecc);
+		return;
+	}
+
+	/* 64 words; each iteration covers word indices 4i .. 4i+3 */
+	for (i = 0; i < 16; i++) {
+		w0 = *wp++;
+		w1 = *wp++;
+		w2 = *wp++;
+		w3 = *wp++;
+
+		odd1 ^= w1 ^ w3;	/* word index bit 0 */
+		odd2 ^= w2 ^ w3;	/* word index bit 1 */
+		t = w0 ^ w1 ^ w2 ^ w3;
+		all ^= t;
+		if (i & 1)
+			p4 ^= t;
+		if (i & 2)
+			p8 ^= t;
+		if (i & 4)
+			p16 ^= t;
+		if (i & 8)
+			p32 ^= t;
+	}
+
+	col_parity = column_parity_table[ab[0] ^ ab[1] ^ ab[2] ^ ab[3]];
+
+	line_parity = 0;
+	if (column_parity_table[ab[1] ^ ab[3]] & 0x01)
+		line_parity |= 0x01;
+	if (column_parity_table[ab[2] ^ ab[3]] & 0x01)
+		line_parity |= 0x02;
+	if (yaffs_Parity32(odd1))
+		line_parity |= 0x04;
+	if (yaffs_Parity32(odd2))
+		line_parity |= 0x08;
+	if (yaffs_Parity32(p4))
+		line_parity |= 0x10;
+	if (yaffs_Parity32(p8))
+		line_parity |= 0x20;
+	if (yaffs_Parity32(p16))
+		line_parity |= 0x40;
+	if (yaffs_Parity32(p32))
+		line_parity |= 0x80;
+
+	yaffs_ECCPack(col_parity, line_parity,
+		      (col_parity & 0x01) ? ~line_parity : line_parity, ecc);
+}
+
 
 /* Correct the ECC on a 256 byte block of data */
 
@@ -324,3 +416,86 @@ int yaffs_ECCCorrectOther(unsigned char *data, unsigned nBytes,
 
 	return -1;
 }
+
+#if defined(__KERNEL__) && defined(CONFIG_YAFFS_ECC_SELFTEST)
+#include <linux/random.h>
+#include <linux/ktime.h>
+
+#define YAFFS_ECC_TEST_BLOCKS	64
+#define YAFFS_ECC_TEST_ROUNDS	64
+
+/*
+ * Check the word-at-a-time ECC against the byte-wise reference on random
+ * and mostly-erased blocks, verify single bit correction, and report the
+ * throughput of both.
+ */
+int yaffs_ECCSelfTest(void)
+{
+	unsigned char *buf;
+	unsigned char ecc[3], ref[3], test[3];
+	unsigned i, r, bit;
+	ktime_t start;
+	s64 word_ns, byte_ns;
+	int error = 0;
+
+	buf = vmalloc(YAFFS_ECC_TEST_BLOCKS * 256);
+	if (!buf)
+		return -ENOMEM;
+
+	/*
+	 * Block 0 is erased, and block 1 is erased but for a few bits that
+	 * were programmed, as in a page that holds little data.
+	 */
+	get_random_bytes(buf, YAFFS_ECC_TEST_BLOCKS * 256);
+	memset(buf, 0xff, 2 * 256);
+	for (i = 0; i < 4; i++) {
+		bit = (i * 509 + 3) & 2047;
+		buf[256 + (bit >> 3)] &= ~(1 << (bit & 7));
+	}
+
+	for (i = 0; i < YAFFS_ECC_TEST_BLOCKS && !error; i++) {
+		unsigned char *blk = buf + i * 256;
+
+		yaffs_ECCCalculate(blk, ecc);
+		yaffs_ECCCalculateBytewise(blk, ref);
+		if (memcmp(ecc, ref, 3)) {
+			printk(KERN_ERR "yaffs: ecc mismatch in block %u: "
+			       "%02x%02x%02x != %02x%02x%02x\n", i,
+			       ecc[0], ecc[1], ecc[2], ref[0], ref[1], ref[2]);
+			error = -EINVAL;
+			break;
+		}
+
+		bit = (i * 97) & 2047;
+		blk[bit >> 3] ^= 1 << (bit & 7);
+		yaffs_ECCCalculate(blk, test);
+		if (yaffs_ECCCorrect(blk, ecc, test) != 1) {
+			printk(KERN_ERR "yaffs: ecc failed to correct bit %u "
+			       "in block %u\n", bit, i);
+			error = -EINVAL;
+		}
+	}
+
+	if (!error) {
+		start = ktime_get();
+		for (r = 0; r < YAFFS_ECC_TEST_ROUNDS; r++)
+			for (i = 0; i < YAFFS_ECC_TEST_BLOCKS; i++)
+				yaffs_ECCCalculate(buf + i * 256, ecc);
+		word_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		start = ktime_get();
+		for (r = 0; r < YAFFS_ECC_TEST_ROUNDS; r++)
+			for (i = 0; i < YAFFS_ECC_TEST_BLOCKS; i++)
+				yaffs_ECCCalculateBytewise(buf + i * 256, ecc);
+		byte_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		printk(KERN_INFO "yaffs: ecc self-test passed, %u KiB in "
+		       "%lld ns (word) / %lld ns (byte)\n",
+		       YAFFS_ECC_TEST_ROUNDS * YAFFS_ECC_TEST_BLOCKS / 4,
+		       word_ns, byte_ns);
+	}
+
+	vfree(buf);
+	return error;
+}
+#endif
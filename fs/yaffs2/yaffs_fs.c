@@ -112,6 +112,7 @@ static uint32_t YCALCBLOCKS(uint64_t partition_size, uint32_t block_size)
 
 #include "yportenv.h"
 #include "yaffs_guts.h"
+#include "yaffs_ecc.h"
 
 #include <linux/mtd/mtd.h>
 #include "yaffs_mtdif.h"
@@ -2631,6 +2632,12 @@ static int __init init_yaffs_fs(void)
 	T(YAFFS_TRACE_ALWAYS,
 	  ("yaffs " __DATE__ " " __TIME__ " Installing. \n"));
 
+#ifdef CONFIG_YAFFS_ECC_SELFTEST
+	error = yaffs_ECCSelfTest();
+	if (error)
+		return error;
+#endif
+
 	/* Install the proc_fs entry */
 	my_proc_entry = create_proc_entry("yaffs",
 					       S_IRUGO | S_IFREG,
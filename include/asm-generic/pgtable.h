@@ -344,6 +344,18 @@ extern void untrack_pfn_vma(struct vm_area_struct *vma, unsigned long pfn,
 				unsigned long size);
 #endif
 
+#ifndef __HAVE_ARCH_MAP_PFN_RANGE_LARGE
+/*
+ * Called by remap_pfn_range() once [addr, end) of vma maps physically
+ * contiguous memory.  Architectures whose MMU has larger pages than
+ * PAGE_SIZE can switch suitably aligned parts of the range to them.
+ */
+static inline void arch_map_pfn_range_large(struct vm_area_struct *vma,
+					unsigned long addr, unsigned long end)
+{
+}
+#endif
+
 #endif /* !__ASSEMBLY__ */
 
 #endif /* _ASM_GENERIC_PGTABLE_H */
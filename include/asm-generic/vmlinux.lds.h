@@ -594,10 +594,17 @@
   	*(.initcall5.init)						\
   	*(.initcall5s.init)						\
 	*(.initcallrootfs.init)						\
+	VMLINUX_SYMBOL(__initcall_async_start) = .;			\
+	*(.initcall6a.init)						\
+	VMLINUX_SYMBOL(__initcall_async_end) = .;			\
   	*(.initcall6.init)						\
+	VMLINUX_SYMBOL(__initcall_async_sync) = .;			\
   	*(.initcall6s.init)						\
   	*(.initcall7.init)						\
-  	*(.initcall7s.init)
+  	*(.initcall7s.init)						\
+	VMLINUX_SYMBOL(__deferred_initcall_start) = .;			\
+	*(.initcalldeferred.init)					\
+	VMLINUX_SYMBOL(__deferred_initcall_end) = .;
 
 #define INIT_CALLS							\
 		VMLINUX_SYMBOL(__initcall_start) = .;			\
@@ -193,6 +193,14 @@ struct request {
 
 	struct gendisk *rq_disk;
 	unsigned long start_time;
+#ifdef CONFIG_BLK_IO_LATENCY
+	u64 queue_time_ns;		/* when the request was queued */
+	u64 io_start_time_ns;		/* when the driver started it */
+	/* what the driver was given, for tracing after completion */
+	sector_t io_start_sector;
+	unsigned int io_start_nr_sectors;
+	unsigned int io_start_cmd_flags;
+#endif
 
 	/* Number of scatter-gather DMA addr+len pairs after
 	 * physical address coalescing is performed.
@@ -256,6 +264,18 @@ struct request_pm_state
 
 #include <linux/elevator.h>
 
+/*
+ * Log2 histograms of request latencies in microseconds: bucket 0 counts
+ * requests under 1us, bucket n those from 2^(n-1) to 2^n us, and the last
+ * one everything longer.
+ */
+#define BLK_LAT_BUCKETS		24
+
+struct blk_latency_hist {
+	unsigned long		queue[2][BLK_LAT_BUCKETS];
+	unsigned long		service[2][BLK_LAT_BUCKETS];
+};
+
 typedef void (request_fn_proc) (struct request_queue *q);
 typedef int (make_request_fn) (struct request_queue *q, struct bio *bio);
 typedef int (prep_rq_fn) (struct request_queue *, struct request *);
@@ -438,6 +458,11 @@ struct request_queue
 #if defined(CONFIG_BLK_DEV_BSG)
 	struct bsg_class_device bsg_dev;
 #endif
+
+#ifdef CONFIG_BLK_IO_LATENCY
+	/* protected by queue_lock */
+	struct blk_latency_hist	lat_hist;
+#endif
 };
 
 #define QUEUE_FLAG_CLUSTER	0	/* cluster several segments into 1 */
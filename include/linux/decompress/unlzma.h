@@ -9,4 +9,11 @@ int unlzma(unsigned char *, int,
 	   void(*error)(char *x)
 	);
 
+/* Bytes of workspace unlzma_workspace() needs for lc + lp <= lclp */
+#define UNLZMA_WORKSPACE_SIZE(lclp)	((1846 + (0x300 << (lclp))) * 2)
+
+int unlzma_workspace(unsigned char *buf, int in_len, unsigned char *output,
+		     int *posp, void(*error)(char *x),
+		     void *workspace, int workspace_size);
+
 #endif
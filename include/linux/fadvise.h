@@ -18,4 +18,7 @@
 #define POSIX_FADV_NOREUSE	5 /* Data will be accessed once.  */
 #endif
 
+/* Linux specific: record accesses for FS_IOC_RATRACE_GET. */
+#define POSIX_FADV_RECORD	8
+
 #endif	/* FADVISE_H_INCLUDED */
@@ -276,6 +276,25 @@ __alloc_pages(gfp_t gfp_mask, unsigned int order,
 	return __alloc_pages_nodemask(gfp_mask, order, zonelist, NULL);
 }
 
+extern unsigned long __alloc_pages_bulk(gfp_t gfp_mask, int nid,
+			unsigned long nr_pages, struct list_head *page_list,
+			struct page **page_array);
+
+/* Allocate up to nr_pages order-0 pages, see __alloc_pages_bulk() */
+static inline unsigned long
+alloc_pages_bulk_array(gfp_t gfp_mask, unsigned long nr_pages,
+			struct page **page_array)
+{
+	return __alloc_pages_bulk(gfp_mask, -1, nr_pages, NULL, page_array);
+}
+
+static inline unsigned long
+alloc_pages_bulk_list(gfp_t gfp_mask, unsigned long nr_pages,
+			struct list_head *page_list)
+{
+	return __alloc_pages_bulk(gfp_mask, -1, nr_pages, page_list, NULL);
+}
+
 static inline struct page *alloc_pages_node(int nid, gfp_t gfp_mask,
 						unsigned int order)
 {
@@ -200,6 +200,27 @@ extern void (*late_time_init)(void);
 #define late_initcall(fn)		__define_initcall("7",fn,7)
 #define late_initcall_sync(fn)		__define_initcall("7s",fn,7s)
 
+/*
+ * Async device initcalls are started before the other device initcalls
+ * and run in parallel with them, from kernel/async.c threads.  All of
+ * them have finished before device_initcall_sync() calls are made.
+ * Only use this for calls that do not depend on the order in which the
+ * device initcalls run, e.g. drivers whose probe only sleeps on its
+ * own hardware.
+ */
+#define device_initcall_async(fn)	__define_initcall("6a",fn,6a)
+
+/*
+ * Deferred initcalls are not run at boot, but when userspace asks for
+ * them through /proc/deferred_initcalls, once the root filesystem is up.
+ * They are meant for drivers that are not needed to start userspace.
+ */
+#ifdef CONFIG_DEFERRED_INITCALLS
+#define deferred_initcall(fn)		__define_initcall("deferred",fn,deferred)
+#else
+#define deferred_initcall(fn)		device_initcall(fn)
+#endif
+
 #define __initcall(fn) device_initcall(fn)
 
 #define __exitcall(fn) \
@@ -278,6 +299,8 @@ void __init parse_early_options(char *cmdline);
 #define subsys_initcall(fn)		module_init(fn)
 #define fs_initcall(fn)			module_init(fn)
 #define device_initcall(fn)		module_init(fn)
+#define device_initcall_async(fn)	module_init(fn)
+#define deferred_initcall(fn)		module_init(fn)
 #define late_initcall(fn)		module_init(fn)
 
 #define security_initcall(fn)		module_init(fn)
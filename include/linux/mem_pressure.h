@@ -0,0 +1,24 @@
+#ifndef _LINUX_MEM_PRESSURE_H
+#define _LINUX_MEM_PRESSURE_H
+
+/*
+ * Memory pressure notification, see Documentation/vm/mem-pressure.txt.
+ * Page reclaim reports how well it is doing, and tasks waiting on
+ * /dev/mem_pressure are told when it gets into trouble.
+ */
+
+#ifdef CONFIG_MEMORY_PRESSURE
+extern void mem_pressure_account(unsigned long scanned,
+				 unsigned long reclaimed);
+extern void mem_pressure_prio(int priority);
+#else
+static inline void mem_pressure_account(unsigned long scanned,
+					unsigned long reclaimed)
+{
+}
+static inline void mem_pressure_prio(int priority)
+{
+}
+#endif
+
+#endif /* _LINUX_MEM_PRESSURE_H */
@@ -116,6 +116,12 @@ extern unsigned int kobjsize(const void *objp);
 #define VM_STACK_FLAGS	(VM_GROWSDOWN | VM_STACK_DEFAULT_FLAGS | VM_ACCOUNT)
 #endif
 
+/*
+ * The stack vma of a new program carries both read hints while exec()
+ * moves it into place.  Page migration leaves such vmas alone.
+ */
+#define VM_STACK_INCOMPLETE_SETUP	(VM_RAND_READ | VM_SEQ_READ)
+
 #define VM_READHINTMASK			(VM_SEQ_READ | VM_RAND_READ)
 #define VM_ClearReadHint(v)		(v)->vm_flags &= ~VM_READHINTMASK
 #define VM_NormalReadHint(v)		(!((v)->vm_flags & VM_READHINTMASK))
@@ -332,6 +338,7 @@ void put_page(struct page *page);
 void put_pages_list(struct list_head *pages);
 
 void split_page(struct page *page, unsigned int order);
+int split_free_page(struct page *page);
 
 /*
  * Compound pages have a destructor function.  Provide a
@@ -872,6 +879,7 @@ int __get_user_pages_fast(unsigned long start, int nr_pages, int write,
 struct shrinker {
 	int (*shrink)(int nr_to_scan, gfp_t gfp_mask);
 	int seeks;	/* seeks to recreate an obj */
+	int soft_reclaim; /* may be shrunk by kswapd's soft reclaim */
 
 	/* These are for internal use */
 	struct list_head list;
@@ -1194,6 +1202,36 @@ unsigned long ra_submit(struct file_ra_state *ra,
 			struct address_space *mapping,
 			struct file *filp);
 
+struct ra_trace;
+#ifdef CONFIG_READAHEAD_TRACE
+int ra_trace_start(struct file *filp, pgoff_t start, pgoff_t end);
+void ra_trace_release(struct file *filp);
+int ra_trace_get(struct file *filp, struct ra_trace __user *utrace);
+int ra_trace_replay(struct file *filp, struct ra_trace __user *utrace);
+#else
+static inline int ra_trace_start(struct file *filp, pgoff_t start,
+				 pgoff_t end)
+{
+	return -EINVAL;
+}
+
+static inline void ra_trace_release(struct file *filp)
+{
+}
+
+static inline int ra_trace_get(struct file *filp,
+			       struct ra_trace __user *utrace)
+{
+	return -ENOTTY;
+}
+
+static inline int ra_trace_replay(struct file *filp,
+				  struct ra_trace __user *utrace)
+{
+	return -ENOTTY;
+}
+#endif
+
 /* Do stack extension */
 extern int expand_stack(struct vm_area_struct *vma, unsigned long address);
 #ifdef CONFIG_IA64
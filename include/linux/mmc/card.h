@@ -44,6 +44,7 @@ struct mmc_ext_csd {
 	unsigned int		sa_timeout;		/* Units: 100ns */
 	unsigned int		hs_max_dtr;
 	unsigned int		sectors;
+	u8			max_packed_writes;	/* 0: not supported */
 };
 
 struct sd_scr {
@@ -46,6 +46,16 @@ struct mmc_host_ops {
 	int (*enable)(struct mmc_host *host);
 	int (*disable)(struct mmc_host *host, int lazy);
 	void	(*request)(struct mmc_host *host, struct mmc_request *req);
+	/*
+	 * Optional: pre_req() is called before the request is started,
+	 * possibly while another request is still in progress, so the
+	 * host can do its preparation (e.g. dma_map_sg) early. post_req()
+	 * is called once the request has completed to undo it.
+	 */
+	void	(*pre_req)(struct mmc_host *host, struct mmc_request *req,
+			   bool is_first_req);
+	void	(*post_req)(struct mmc_host *host, struct mmc_request *req,
+			    int err);
 	void	(*set_ios)(struct mmc_host *host, struct mmc_ios *ios);
 	int	(*get_ro)(struct mmc_host *host);
 	int	(*get_cd)(struct mmc_host *host);
@@ -259,6 +259,8 @@ struct _mmc_csd {
 #define EXT_CSD_REV		192	/* RO */
 #define EXT_CSD_SEC_CNT		212	/* RO, 4 bytes */
 #define EXT_CSD_S_A_TIMEOUT	217
+#define EXT_CSD_MAX_PACKED_WRITES	500	/* RO */
+#define EXT_CSD_MAX_PACKED_READS	501	/* RO */
 
 /*
  * EXT_CSD field definitions
@@ -275,6 +277,20 @@ struct _mmc_csd {
 #define EXT_CSD_BUS_WIDTH_4	1	/* Card is in 4 bit mode */
 #define EXT_CSD_BUS_WIDTH_8	2	/* Card is in 8 bit mode */
 
+/*
+ * SET_BLOCK_COUNT (CMD23) argument bits
+ */
+
+#define MMC_CMD23_ARG_REL_WR	(1 << 31)	/* Reliable write */
+#define MMC_CMD23_ARG_PACKED	(1 << 30)	/* Packed command follows */
+
+/*
+ * Packed command header, sent as the first block of a packed write
+ */
+
+#define MMC_PACKED_CMD_VER	0x01
+#define MMC_PACKED_CMD_WR	0x02
+
 /*
  * MMC_SWITCH access modes
  */
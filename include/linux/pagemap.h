@@ -434,7 +434,7 @@ int add_to_page_cache_locked(struct page *page, struct address_space *mapping,
 int add_to_page_cache_lru(struct page *page, struct address_space *mapping,
 				pgoff_t index, gfp_t gfp_mask);
 extern void remove_from_page_cache(struct page *page);
-extern void __remove_from_page_cache(struct page *page);
+extern void __remove_from_page_cache(struct page *page, void *shadow);
 
 /*
  * Like add_to_page_cache_locked, but used to add newly allocated pages:
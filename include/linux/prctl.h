@@ -102,4 +102,11 @@
 
 #define PR_MCE_KILL_GET 34
 
+/*
+ * Get/set lazy fork: fork() leaves out the page table entries that the
+ * child can fault back in, see Documentation/vm/lazy-fork.txt
+ */
+#define PR_SET_LAZY_FORK 35
+#define PR_GET_LAZY_FORK 36
+
 #endif /* _LINUX_PRCTL_H */
@@ -0,0 +1,29 @@
+/*
+ * Recorded readahead: FS_IOC_RATRACE_GET/FS_IOC_RATRACE_REPLAY interface.
+ *
+ * Accesses to a file are recorded after POSIX_FADV_RECORD, fetched as a
+ * list of extents with FS_IOC_RATRACE_GET, and can later be handed back
+ * with FS_IOC_RATRACE_REPLAY to read them all in in one go.
+ *
+ * See Documentation/vm/readahead-trace.txt.
+ */
+
+#ifndef _LINUX_RA_TRACE_H
+#define _LINUX_RA_TRACE_H
+
+#include <linux/types.h>
+
+struct ra_trace_extent {
+	__u64 re_start;		/* byte offset of the extent in the file */
+	__u64 re_length;	/* length of the extent in bytes */
+};
+
+struct ra_trace {
+	__u32 rt_count;		/* GET: in, size of rt_extents; out, number
+				 * of extents in the trace.
+				 * REPLAY: number of extents in rt_extents */
+	__u32 rt_reserved;
+	struct ra_trace_extent rt_extents[0];
+};
+
+#endif /* _LINUX_RA_TRACE_H */
@@ -38,6 +38,16 @@
 #define RADIX_TREE_INDIRECT_PTR	1
 #define RADIX_TREE_RETRY ((void *)-1UL)
 
+/*
+ * A slot may also hold an exceptional entry instead of a pointer to an
+ * item.  Bit 1 is set in it, and the value proper is stored from bit 2
+ * upwards.  The page cache keeps one in the slot of an evicted page (see
+ * mm/workingset.c).  Exceptional entries are returned by lookups like
+ * any other item, so the callers that may find one must check for it.
+ */
+#define RADIX_TREE_EXCEPTIONAL_ENTRY	2
+#define RADIX_TREE_EXCEPTIONAL_SHIFT	2
+
 static inline void *radix_tree_ptr_to_indirect(void *ptr)
 {
 	return (void *)((unsigned long)ptr | RADIX_TREE_INDIRECT_PTR);
@@ -53,6 +63,11 @@ static inline int radix_tree_is_indirect_ptr(void *ptr)
 	return (int)((unsigned long)ptr & RADIX_TREE_INDIRECT_PTR);
 }
 
+static inline int radix_tree_exceptional_entry(void *arg)
+{
+	return (int)((unsigned long)arg & RADIX_TREE_EXCEPTIONAL_ENTRY);
+}
+
 /*** radix-tree API starts here ***/
 
 #define RADIX_TREE_MAX_TAGS 2
@@ -164,7 +179,8 @@ radix_tree_gang_lookup(struct radix_tree_root *root, void **results,
 			unsigned long first_index, unsigned int max_items);
 unsigned int
 radix_tree_gang_lookup_slot(struct radix_tree_root *root, void ***results,
-			unsigned long first_index, unsigned int max_items);
+			unsigned long *indices, unsigned long first_index,
+			unsigned int max_items);
 unsigned long radix_tree_next_hole(struct radix_tree_root *root,
 				unsigned long index, unsigned long max_scan);
 unsigned long radix_tree_prev_hole(struct radix_tree_root *root,
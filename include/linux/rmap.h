@@ -35,6 +35,14 @@ struct anon_vma {
 	 * mm_take_all_locks() (mm_all_locks_mutex).
 	 */
 	struct list_head head;	/* List of private "related" vmas */
+#ifdef CONFIG_MIGRATION
+	/*
+	 * References taken by page migration, which may have to restore
+	 * the ptes of a page after all of its vmas went away.  The
+	 * anon_vma is only freed once this drops to zero.
+	 */
+	atomic_t migrate_refcount;
+#endif
 };
 
 #ifdef CONFIG_MMU
@@ -125,6 +133,21 @@ int try_to_munlock(struct page *);
  */
 struct anon_vma *page_lock_anon_vma(struct page *page);
 void page_unlock_anon_vma(struct anon_vma *anon_vma);
+
+#ifdef CONFIG_MIGRATION
+struct anon_vma *page_get_anon_vma(struct page *page);
+void drop_anon_vma(struct anon_vma *anon_vma);
+
+static inline int anon_vma_migrate_refcount(struct anon_vma *anon_vma)
+{
+	return atomic_read(&anon_vma->migrate_refcount);
+}
+#else
+static inline int anon_vma_migrate_refcount(struct anon_vma *anon_vma)
+{
+	return 0;
+}
+#endif
 int page_mapped_in_vma(struct page *page, struct vm_area_struct *vma);
 
 #else	/* !CONFIG_MMU */
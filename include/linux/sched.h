@@ -475,6 +475,7 @@ extern int get_dumpable(struct mm_struct *mm);
 #endif
 					/* leave room for more dump flags */
 #define MMF_VM_MERGEABLE	16	/* KSM may merge identical pages */
+#define MMF_LAZY_FORK		17	/* fork() skips refaultable ptes */
 
 #define MMF_INIT_MASK		(MMF_DUMPABLE_MASK | MMF_DUMP_FILTER_MASK)
 
@@ -797,6 +798,10 @@ struct task_delay_info {
 	struct timespec freepages_start, freepages_end;
 	u64 freepages_delay;	/* wait for memory reclaim */
 	u32 freepages_count;	/* total count of memory reclaim */
+
+	struct timespec compact_start, compact_end;
+	u64 compact_delay;	/* wait for direct memory compaction */
+	u32 compact_count;	/* total count of direct compactions */
 };
 #endif	/* CONFIG_TASK_DELAY_ACCT */
 
@@ -56,6 +56,13 @@ struct kmem_cache {
 /* 5) cache creation/removal */
 	const char *name;
 	struct list_head next;
+#ifdef CONFIG_SLAB_LEAN
+	int refcount;			/* kmem_cache_create() users */
+	unsigned int align;		/* object alignment, for merging */
+	unsigned int min_limit;		/* bounds of the per cpu queue limit */
+	unsigned int max_limit;
+	unsigned int lean_misses;	/* queue refills and flushes */
+#endif
 
 /* 6) statistics */
 #ifdef CONFIG_DEBUG_SLAB
@@ -197,6 +197,29 @@ extern unsigned int nr_free_pagecache_pages(void);
 #define nr_free_pages() global_page_state(NR_FREE_PAGES)
 
 
+/* linux/mm/workingset.c */
+#ifdef CONFIG_WORKINGSET
+extern void *workingset_eviction(struct address_space *mapping,
+				 struct page *page);
+extern bool workingset_refault(void *shadow);
+extern void workingset_activation(struct page *page);
+#else
+static inline void *workingset_eviction(struct address_space *mapping,
+					struct page *page)
+{
+	return NULL;
+}
+
+static inline bool workingset_refault(void *shadow)
+{
+	return false;
+}
+
+static inline void workingset_activation(struct page *page)
+{
+}
+#endif
+
 /* linux/mm/swap.c */
 extern void __lru_cache_add(struct page *, enum lru_list lru);
 extern void lru_cache_add_lru(struct page *, enum lru_list lru);
@@ -244,6 +267,10 @@ extern unsigned long mem_cgroup_shrink_node_zone(struct mem_cgroup *mem,
 						unsigned int swappiness,
 						struct zone *zone,
 						int nid);
+/* LRU Isolation modes. */
+#define ISOLATE_INACTIVE 0	/* Isolate inactive pages. */
+#define ISOLATE_ACTIVE 1	/* Isolate active pages. */
+#define ISOLATE_BOTH 2		/* Isolate both active and inactive pages. */
 extern int __isolate_lru_page(struct page *page, int mode, int file);
 extern unsigned long shrink_all_memory(unsigned long nr_pages);
 extern int vm_swappiness;
@@ -274,6 +301,11 @@ extern void scan_unevictable_unregister_node(struct node *node);
 
 extern int kswapd_run(int nid);
 
+extern int sysctl_soft_reclaim_free_kbytes;
+extern int sysctl_soft_reclaim_budget_kbytes;
+extern int soft_reclaim_sysctl_handler(struct ctl_table *, int,
+					void __user *, size_t *, loff_t *);
+
 #ifdef CONFIG_MMU
 /* linux/mm/shmem.c */
 extern int shmem_unuse(swp_entry_t entry, struct page *page);
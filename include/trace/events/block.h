@@ -172,6 +172,56 @@ TRACE_EVENT(block_rq_complete,
 		  __entry->nr_sector, __entry->errors)
 );
 
+#ifdef CONFIG_BLK_IO_LATENCY
+/**
+ * block_rq_latency - request latency at completion
+ * @q: queue containing the request
+ * @rq: the completed request
+ * @queue_ns: time spent queued before the driver started it
+ * @service_ns: time the driver took to complete it
+ *
+ * A compact event for file system requests only, cheap enough to leave
+ * enabled for a production latency monitor.  The request has been used
+ * up by the time it completes, so the sector, length and type are those
+ * saved when the driver started it.
+ */
+TRACE_EVENT(block_rq_latency,
+
+	TP_PROTO(struct request_queue *q, struct request *rq,
+		 u64 queue_ns, u64 service_ns),
+
+	TP_ARGS(q, rq, queue_ns, service_ns),
+
+	TP_STRUCT__entry(
+		__field(  dev_t,	dev			)
+		__field(  sector_t,	sector			)
+		__field(  unsigned int,	nr_sector		)
+		__field(  unsigned int,	queue_us		)
+		__field(  unsigned int,	service_us		)
+		__array(  char,		rwbs,	6		)
+	),
+
+	TP_fast_assign(
+		__entry->dev	    = disk_devt(rq->rq_disk);
+		__entry->sector     = rq->io_start_sector;
+		__entry->nr_sector  = rq->io_start_nr_sectors;
+		__entry->queue_us   = div_u64(queue_ns, NSEC_PER_USEC);
+		__entry->service_us = div_u64(service_ns, NSEC_PER_USEC);
+
+		blk_fill_rwbs(__entry->rwbs,
+			      (rq->io_start_cmd_flags & 0x03) |
+			      (rq->io_start_cmd_flags & REQ_DISCARD ?
+			       1 << BIO_RW_DISCARD : 0),
+			      rq->io_start_nr_sectors << 9);
+	),
+
+	TP_printk("%d,%d %s %llu + %u queue=%uus service=%uus",
+		  MAJOR(__entry->dev), MINOR(__entry->dev), __entry->rwbs,
+		  (unsigned long long)__entry->sector, __entry->nr_sector,
+		  __entry->queue_us, __entry->service_us)
+);
+#endif
+
 TRACE_EVENT(block_bio_bounce,
 
 	TP_PROTO(struct request_queue *q, struct bio *bio),
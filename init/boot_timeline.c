@@ -0,0 +1,190 @@
+/*
+ *  linux/init/boot_timeline.c
+ *
+ *  Records when each initcall ran and for how long, and exports the
+ *  result in debugfs.  See Documentation/boot-timeline.txt.
+ */
+
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+
+#include "boot_timeline.h"
+
+#define BT_MAX_ENTRIES	1024
+
+struct bt_entry {
+	initcall_t	fn;
+	u32		start_us;
+	u32		duration_us;
+	int		type;
+};
+
+struct bt_summary {
+	unsigned int	count[3];
+	u64		total[3];
+	u64		window_serial;
+	u32		async_max;
+	u32		first_us;
+	u32		last_us;
+};
+
+static struct bt_entry *bt_entries;
+static unsigned int bt_count;
+static unsigned int bt_dropped;
+static u32 bt_window_start, bt_window_end;
+static DEFINE_SPINLOCK(bt_lock);
+
+static inline u32 bt_us(ktime_t t)
+{
+	return (u32)ktime_to_us(t);
+}
+
+void __init boot_timeline_init(void)
+{
+	bt_entries = kcalloc(BT_MAX_ENTRIES, sizeof(*bt_entries), GFP_KERNEL);
+	if (!bt_entries)
+		printk(KERN_WARNING "boot timeline: out of memory\n");
+}
+
+/*
+ * Called for every initcall run at boot, and for the deferred ones.
+ * Async initcalls call this concurrently with the serial ones.
+ */
+void boot_timeline_add(initcall_t fn, ktime_t start, ktime_t end, int type)
+{
+	struct bt_entry *e;
+	unsigned long flags;
+
+	spin_lock_irqsave(&bt_lock, flags);
+	if (!bt_entries || bt_count == BT_MAX_ENTRIES) {
+		bt_dropped++;
+	} else {
+		e = &bt_entries[bt_count++];
+		e->fn = fn;
+		e->start_us = bt_us(start);
+		e->duration_us = bt_us(ktime_sub(end, start));
+		e->type = type;
+	}
+	spin_unlock_irqrestore(&bt_lock, flags);
+}
+
+/*
+ * The async initcalls run while the serial device initcalls between
+ * @start and @end go on, so only the longer of the two counts towards
+ * the critical path.
+ */
+void __init boot_timeline_async_window(ktime_t start, ktime_t end)
+{
+	bt_window_start = bt_us(start);
+	bt_window_end = bt_us(end);
+}
+
+static unsigned int bt_summarize(struct bt_summary *s)
+{
+	unsigned int i, count;
+	unsigned long flags;
+
+	/* Entries are never changed once they are added. */
+	spin_lock_irqsave(&bt_lock, flags);
+	count = bt_count;
+	spin_unlock_irqrestore(&bt_lock, flags);
+
+	memset(s, 0, sizeof(*s));
+	for (i = 0; i < count; i++) {
+		struct bt_entry *e = &bt_entries[i];
+
+		s->count[e->type]++;
+		s->total[e->type] += e->duration_us;
+		if (e->type == BOOT_TIMELINE_DEFERRED)
+			continue;
+		if (e->type == BOOT_TIMELINE_ASYNC) {
+			s->async_max = max(s->async_max, e->duration_us);
+		} else if (e->start_us >= bt_window_start &&
+			   e->start_us < bt_window_end) {
+			s->window_serial += e->duration_us;
+		}
+		if (!s->first_us || e->start_us < s->first_us)
+			s->first_us = e->start_us;
+		s->last_us = max(s->last_us, e->start_us + e->duration_us);
+	}
+	return count;
+}
+
+static u64 bt_critical_path(struct bt_summary *s)
+{
+	return s->total[BOOT_TIMELINE_SERIAL] - s->window_serial +
+		max_t(u64, s->window_serial, s->async_max);
+}
+
+void __init boot_timeline_report(void)
+{
+	struct bt_summary s;
+
+	if (!bt_entries)
+		return;
+	bt_summarize(&s);
+	printk(KERN_INFO "boot timeline: %u initcalls in %u us, "
+	       "critical path %llu us\n",
+	       s.count[BOOT_TIMELINE_SERIAL] + s.count[BOOT_TIMELINE_ASYNC],
+	       s.last_us - s.first_us,
+	       (unsigned long long)bt_critical_path(&s));
+}
+
+static int bt_show(struct seq_file *m, void *v)
+{
+	static const char type_char[] = { 's', 'a', 'd' };
+	struct bt_summary s;
+	unsigned int i, count;
+
+	if (!bt_entries)
+		return 0;
+	count = bt_summarize(&s);
+
+	seq_printf(m, "#  start_us   dur_us t initcall\n");
+	for (i = 0; i < count; i++) {
+		struct bt_entry *e = &bt_entries[i];
+
+		seq_printf(m, "%10u %8u %c %pF\n", e->start_us,
+			   e->duration_us, type_char[e->type], e->fn);
+	}
+	seq_printf(m, "# serial: %u calls, %llu us\n",
+		   s.count[BOOT_TIMELINE_SERIAL],
+		   (unsigned long long)s.total[BOOT_TIMELINE_SERIAL]);
+	seq_printf(m, "# async: %u calls, %llu us, longest %u us\n",
+		   s.count[BOOT_TIMELINE_ASYNC],
+		   (unsigned long long)s.total[BOOT_TIMELINE_ASYNC],
+		   s.async_max);
+	seq_printf(m, "# deferred: %u calls, %llu us\n",
+		   s.count[BOOT_TIMELINE_DEFERRED],
+		   (unsigned long long)s.total[BOOT_TIMELINE_DEFERRED]);
+	seq_printf(m, "# wall: %u us, critical path: %llu us\n",
+		   s.last_us - s.first_us,
+		   (unsigned long long)bt_critical_path(&s));
+	if (bt_dropped)
+		seq_printf(m, "# %u initcalls not recorded\n", bt_dropped);
+	return 0;
+}
+
+static int bt_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, bt_show, NULL);
+}
+
+static const struct file_operations bt_fops = {
+	.open		= bt_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init boot_timeline_debugfs_init(void)
+{
+	debugfs_create_file("boot_timeline", 0444, NULL, NULL, &bt_fops);
+	return 0;
+}
+late_initcall(boot_timeline_debugfs_init);
@@ -0,0 +1,21 @@
+#include <linux/init.h>
+#include <linux/ktime.h>
+
+enum {
+	BOOT_TIMELINE_SERIAL,
+	BOOT_TIMELINE_ASYNC,
+	BOOT_TIMELINE_DEFERRED,
+};
+
+#ifdef CONFIG_BOOT_TIMELINE
+void __init boot_timeline_init(void);
+void boot_timeline_add(initcall_t fn, ktime_t start, ktime_t end, int type);
+void __init boot_timeline_async_window(ktime_t start, ktime_t end);
+void __init boot_timeline_report(void);
+#else
+static inline void boot_timeline_init(void) { }
+static inline void boot_timeline_add(initcall_t fn, ktime_t start,
+				     ktime_t end, int type) { }
+static inline void boot_timeline_async_window(ktime_t start, ktime_t end) { }
+static inline void boot_timeline_report(void) { }
+#endif
@@ -69,6 +69,7 @@
 #include <linux/kmemtrace.h>
 #include <linux/sfi.h>
 #include <linux/shmem_fs.h>
+#include <linux/proc_fs.h>
 #include <trace/boot.h>
 
 #include <asm/io.h>
@@ -81,6 +82,8 @@
 #include <asm/smp.h>
 #endif
 
+#include "boot_timeline.h"
+
 static int kernel_init(void *);
 
 extern void init_IRQ(void);
@@ -701,14 +704,13 @@ static void __init do_ctors(void)
 int initcall_debug;
 core_param(initcall_debug, initcall_debug, bool, 0644);
 
-static char msgbuf[64];
-static struct boot_trace_call call;
-static struct boot_trace_ret ret;
-
 int do_one_initcall(initcall_t fn)
 {
 	int count = preempt_count();
 	ktime_t calltime, delta, rettime;
+	struct boot_trace_call call;
+	struct boot_trace_ret ret;
+	char msgbuf[64];
 
 	if (initcall_debug) {
 		call.caller = task_pid_nr(current);
@@ -750,20 +752,139 @@ int do_one_initcall(initcall_t fn)
 	return ret.result;
 }
 
+static int do_timed_initcall(initcall_t fn, int type)
+{
+	ktime_t start = ktime_get();
+	int ret;
+
+	ret = do_one_initcall(fn);
+	boot_timeline_add(fn, start, ktime_get(), type);
+	return ret;
+}
 
 extern initcall_t __initcall_start[], __initcall_end[], __early_initcall_end[];
+extern initcall_t __initcall_async_start[], __initcall_async_end[];
+extern initcall_t __initcall_async_sync[];
+extern initcall_t __deferred_initcall_start[], __deferred_initcall_end[];
+
+/* Set to 0 to run the device_initcall_async() calls serially. */
+static int initcall_async = 1;
+core_param(initcall_async, initcall_async, int, 0444);
+
+static void __init do_async_initcall(void *data, async_cookie_t cookie)
+{
+	do_timed_initcall(data, BOOT_TIMELINE_ASYNC);
+}
 
 static void __init do_initcalls(void)
 {
 	initcall_t *call;
+	ktime_t async_start;
 
-	for (call = __early_initcall_end; call < __initcall_end; call++)
-		do_one_initcall(*call);
+	boot_timeline_init();
+
+	for (call = __early_initcall_end; call < __initcall_async_start; call++)
+		do_timed_initcall(*call, BOOT_TIMELINE_SERIAL);
+
+	/*
+	 * Start the async device initcalls, let them run alongside the
+	 * ordinary device initcalls, and wait for them before the
+	 * device_initcall_sync() level.
+	 */
+	async_start = ktime_get();
+	for (call = __initcall_async_start; call < __initcall_async_end; call++) {
+		if (initcall_async)
+			async_schedule(do_async_initcall, *call);
+		else
+			do_timed_initcall(*call, BOOT_TIMELINE_SERIAL);
+	}
+
+	for (; call < __initcall_async_sync; call++)
+		do_timed_initcall(*call, BOOT_TIMELINE_SERIAL);
+	async_synchronize_full();
+	boot_timeline_async_window(async_start, ktime_get());
+
+	for (; call < __deferred_initcall_start; call++)
+		do_timed_initcall(*call, BOOT_TIMELINE_SERIAL);
 
 	/* Make sure there is no pending stuff from the initcall sequence */
 	flush_scheduled_work();
+	boot_timeline_report();
+}
+
+#ifdef CONFIG_DEFERRED_INITCALLS
+static DEFINE_MUTEX(deferred_initcalls_mutex);
+static int deferred_initcalls_done;
+
+/*
+ * Run the deferred_initcall() calls, then free the init memory that
+ * init_post() has kept for them.  Only the first call does anything.
+ */
+static int run_deferred_initcalls(void)
+{
+	initcall_t *call;
+
+	/* init_post() still runs __init code until the system is up */
+	if (system_state != SYSTEM_RUNNING)
+		return -EBUSY;
+
+	mutex_lock(&deferred_initcalls_mutex);
+	if (!deferred_initcalls_done) {
+		for (call = __deferred_initcall_start;
+		     call < __deferred_initcall_end; call++)
+			do_timed_initcall(*call, BOOT_TIMELINE_DEFERRED);
+		flush_scheduled_work();
+		async_synchronize_full();
+		deferred_initcalls_done = 1;
+		if (call != __deferred_initcall_start)
+			free_initmem();
+	}
+	mutex_unlock(&deferred_initcalls_mutex);
+	return 0;
+}
+
+static ssize_t deferred_initcalls_write(struct file *file,
+					const char __user *buf,
+					size_t count, loff_t *ppos)
+{
+	int ret;
+
+	ret = run_deferred_initcalls();
+	return ret ? ret : count;
+}
+
+static const struct file_operations deferred_initcalls_fops = {
+	.write		= deferred_initcalls_write,
+};
+
+/* Seconds after which the deferred initcalls run if nobody asked. */
+static int deferred_initcalls_timeout = 30;
+core_param(deferred_initcalls_timeout, deferred_initcalls_timeout, int, 0444);
+
+static int deferred_initcalls_thread(void *unused)
+{
+	schedule_timeout_interruptible(deferred_initcalls_timeout * HZ);
+	run_deferred_initcalls();
+	return 0;
+}
+
+static void start_deferred_initcalls_timeout(void)
+{
+	if (deferred_initcalls_timeout > 0)
+		kthread_run(deferred_initcalls_thread, NULL, "deferred_init");
 }
 
+static int __init deferred_initcalls_init(void)
+{
+	proc_create("deferred_initcalls", S_IWUSR, NULL,
+		    &deferred_initcalls_fops);
+	return 0;
+}
+late_initcall(deferred_initcalls_init);
+#else
+static inline void start_deferred_initcalls_timeout(void) { }
+#endif
+
 /*
  * Ok, the machine is now initialized. None of the devices
  * have been touched yet, but the CPU subsystem is up and
@@ -805,7 +926,11 @@ static noinline int init_post(void)
 {
 	/* need to finish all async __init code before freeing the memory */
 	async_synchronize_full();
-	free_initmem();
+	/* deferred initcalls are still to come, they free it themselves */
+	if (__deferred_initcall_end - __deferred_initcall_start == 0)
+		free_initmem();
+	else
+		start_deferred_initcalls_timeout();
 	unlock_kernel();
 	mark_rodata_ro();
 	system_state = SYSTEM_RUNNING;
@@ -148,9 +148,12 @@ int __delayacct_add_tsk(struct taskstats *d, struct task_struct *tsk)
 	d->swapin_delay_total = (tmp < d->swapin_delay_total) ? 0 : tmp;
 	tmp = d->freepages_delay_total + tsk->delays->freepages_delay;
 	d->freepages_delay_total = (tmp < d->freepages_delay_total) ? 0 : tmp;
+	tmp = d->compact_delay_total + tsk->delays->compact_delay;
+	d->compact_delay_total = (tmp < d->compact_delay_total) ? 0 : tmp;
 	d->blkio_count += tsk->delays->blkio_count;
 	d->swapin_count += tsk->delays->swapin_count;
 	d->freepages_count += tsk->delays->freepages_count;
+	d->compact_count += tsk->delays->compact_count;
 	spin_unlock_irqrestore(&tsk->delays->lock, flags);
 
 done:
@@ -182,3 +185,16 @@ void __delayacct_freepages_end(void)
 			&current->delays->freepages_count);
 }
 
+void __delayacct_compact_start(void)
+{
+	delayacct_start(&current->delays->compact_start);
+}
+
+void __delayacct_compact_end(void)
+{
+	delayacct_end(&current->delays->compact_start,
+			&current->delays->compact_end,
+			&current->delays->compact_delay,
+			&current->delays->compact_count);
+}
+
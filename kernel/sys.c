@@ -1579,6 +1579,23 @@ SYSCALL_DEFINE5(prctl, int, option, unsigned long, arg2, unsigned long, arg3,
 			else
 				error = PR_MCE_KILL_DEFAULT;
 			break;
+		case PR_SET_LAZY_FORK:
+			if (arg2 > 1 || (arg3 | arg4 | arg5))
+				return -EINVAL;
+			if (!me->mm)
+				return -EINVAL;
+			if (arg2)
+				set_bit(MMF_LAZY_FORK, &me->mm->flags);
+			else
+				clear_bit(MMF_LAZY_FORK, &me->mm->flags);
+			error = 0;
+			break;
+		case PR_GET_LAZY_FORK:
+			if (arg2 | arg3 | arg4 | arg5)
+				return -EINVAL;
+			error = me->mm &&
+				test_bit(MMF_LAZY_FORK, &me->mm->flags);
+			break;
 		default:
 			error = -EINVAL;
 			break;
@@ -34,6 +34,12 @@
 #else
 #include <linux/decompress/unlzma.h>
 #include <linux/slab.h>
+#include <linux/module.h>
+
+/* Keep unlzma() after boot when it is used outside initramfs/initrd */
+#ifdef CONFIG_DECOMPRESS_LZMA_NEEDED
+#define INIT
+#endif
 #endif /* STATIC */
 
 #include <linux/decompress/mm.h>
@@ -74,6 +80,8 @@ struct rc {
 	uint32_t code;
 	uint32_t range;
 	uint32_t bound;
+	int error;
+	uint8_t eof_byte;
 };
 
 
@@ -90,11 +98,20 @@ static int nofill(void *buffer, unsigned int len)
 /* Called twice: once at startup and once in rc_normalize() */
 static void INIT rc_read(struct rc *rc)
 {
-	rc->buffer_size = rc->fill((char *)rc->buffer, LZMA_IOBUF_SIZE);
-	if (rc->buffer_size <= 0)
+	if (!rc->error) {
+		rc->buffer_size = rc->fill((char *)rc->buffer, LZMA_IOBUF_SIZE);
+		if (rc->buffer_size > 0) {
+			rc->ptr = rc->buffer;
+			rc->buffer_end = rc->buffer + rc->buffer_size;
+			return;
+		}
 		error("unexpected EOF");
-	rc->ptr = rc->buffer;
-	rc->buffer_end = rc->buffer + rc->buffer_size;
+		rc->error = 1;
+	}
+	/* Decode zeroes until unlzma() notices the error */
+	rc->eof_byte = 0;
+	rc->ptr = &rc->eof_byte;
+	rc->buffer_end = rc->ptr + 1;
 }
 
 /* Called once */
@@ -113,6 +130,7 @@ static inline void INIT rc_init(struct rc *rc,
 
 	rc->code = 0;
 	rc->range = 0xFFFFFFFF;
+	rc->error = 0;
 }
 
 static inline void INIT rc_init_code(struct rc *rc)
@@ -288,6 +306,7 @@ struct writer {
 	size_t global_pos;
 	int(*flush)(void*, unsigned int);
 	struct lzma_header *header;
+	int error;
 };
 
 struct cstate {
@@ -309,6 +328,11 @@ static inline uint8_t INIT peek_old_byte(struct writer *wr,
 		while (offs > wr->header->dict_size)
 			offs -= wr->header->dict_size;
 		pos = wr->buffer_pos - offs;
+		/* A corrupt distance must not reach before the output */
+		if (pos < 0) {
+			wr->error = 1;
+			return 0;
+		}
 		return wr->buffer[pos];
 	} else {
 		uint32_t pos = wr->buffer_pos - offs;
@@ -531,12 +555,18 @@ static inline void INIT process_bit1(struct writer *wr, struct rc *rc,
 
 
 
-STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
+/*
+ * Returns 0 on success, or -1 if the input is truncated or corrupt.  The
+ * probabilities are allocated here unless the caller passes a workspace
+ * of workspace_size bytes to hold them.
+ */
+static int INIT __unlzma(unsigned char *buf, int in_len,
 			      int(*fill)(void*, unsigned int),
 			      int(*flush)(void*, unsigned int),
 			      unsigned char *output,
 			      int *posp,
-			      void(*error_fn)(char *x)
+			      void(*error_fn)(char *x),
+			      void *workspace, int workspace_size
 	)
 {
 	struct lzma_header header;
@@ -571,6 +601,7 @@ STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
 	wr.global_pos = 0;
 	wr.previous_byte = 0;
 	wr.buffer_pos = 0;
+	wr.error = 0;
 
 	rc_init(&rc, fill, inbuf, in_len);
 
@@ -580,8 +611,13 @@ STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
 		((unsigned char *)&header)[i] = *rc.ptr++;
 	}
 
-	if (header.pos >= (9 * 5 * 5))
+	if (rc.error)
+		goto exit_1;
+
+	if (header.pos >= (9 * 5 * 5)) {
 		error("bad header");
+		goto exit_1;
+	}
 
 	mi = 0;
 	lc = header.pos;
@@ -614,7 +650,14 @@ STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
 		goto exit_1;
 
 	num_probs = LZMA_BASE_SIZE + (LZMA_LIT_SIZE << (lc + lp));
-	p = (uint16_t *) large_malloc(num_probs * sizeof(*p));
+	if (workspace) {
+		if (num_probs * (int)sizeof(*p) > workspace_size) {
+			error("lc + lp too large for workspace");
+			goto exit_2;
+		}
+		p = workspace;
+	} else
+		p = (uint16_t *) large_malloc(num_probs * sizeof(*p));
 	if (p == 0)
 		goto exit_2;
 	num_probs = LZMA_LITERAL + (LZMA_LIT_SIZE << (lc + lp));
@@ -623,7 +666,7 @@ STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
 
 	rc_init_code(&rc);
 
-	while (get_pos(&wr) < header.dst_size) {
+	while (get_pos(&wr) < header.dst_size && !rc.error && !wr.error) {
 		int pos_state =	get_pos(&wr) & pos_state_mask;
 		uint16_t *prob = p + LZMA_IS_MATCH +
 			(cst.state << LZMA_NUM_POS_BITS_MAX) + pos_state;
@@ -637,12 +680,21 @@ STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
 		}
 	}
 
+	if (rc.error)
+		goto exit_3;
+	if (wr.error) {
+		error("bad match distance");
+		goto exit_3;
+	}
+
 	if (posp)
 		*posp = rc.ptr-rc.buffer;
 	if (wr.flush)
 		wr.flush(wr.buffer, wr.buffer_pos);
 	ret = 0;
-	large_free(p);
+exit_3:
+	if (!workspace)
+		large_free(p);
 exit_2:
 	if (!output)
 		large_free(wr.buffer);
@@ -653,6 +705,36 @@ exit_0:
 	return ret;
 }
 
+STATIC inline int INIT unlzma(unsigned char *buf, int in_len,
+			      int(*fill)(void*, unsigned int),
+			      int(*flush)(void*, unsigned int),
+			      unsigned char *output,
+			      int *posp,
+			      void(*error_fn)(char *x)
+	)
+{
+	return __unlzma(buf, in_len, fill, flush, output, posp, error_fn,
+			NULL, 0);
+}
+
+#if !defined(PREBOOT) && defined(CONFIG_DECOMPRESS_LZMA_NEEDED)
+EXPORT_SYMBOL(unlzma);
+
+/*
+ * Decompress the whole of buf into output, keeping the probabilities in
+ * a caller supplied workspace of at least UNLZMA_WORKSPACE_SIZE(lc + lp)
+ * bytes, so nothing is allocated per call.
+ */
+int unlzma_workspace(unsigned char *buf, int in_len, unsigned char *output,
+		     int *posp, void(*error_fn)(char *x),
+		     void *workspace, int workspace_size)
+{
+	return __unlzma(buf, in_len, NULL, NULL, output, posp, error_fn,
+			workspace, workspace_size);
+}
+EXPORT_SYMBOL(unlzma_workspace);
+#endif
+
 #ifdef PREBOOT
 STATIC int INIT decompress(unsigned char *buf, int in_len,
 			      int(*fill)(void*, unsigned int),
@@ -0,0 +1,260 @@
+/*
+ * decompress_unlzo.c
+ *
+ * Decompressor for the output of lzop, on top of the LZO1X
+ * decompressor in lib/lzo.
+ *
+ * The file starts with a header that describes it, followed by blocks of
+ * at most 256KB of uncompressed data.  Each block starts with its
+ * uncompressed and compressed sizes (big endian), followed by its
+ * checksums and the compressed data.  A block whose uncompressed size is
+ * 0 ends the file.  Blocks that did not compress are stored as they are.
+ *
+ * Licensed under the GNU General Public License version 2.
+ */
+
+#ifdef STATIC
+#include "lzo/lzo1x_decompress.c"
+#else
+#include <linux/slab.h>
+#include <linux/decompress/unlzo.h>
+#endif
+
+#include <linux/types.h>
+#include <linux/lzo.h>
+#include <linux/decompress/mm.h>
+
+#include <linux/compiler.h>
+#include <asm/unaligned.h>
+
+static const unsigned char lzop_magic[] = {
+	0x89, 0x4c, 0x5a, 0x4f, 0x00, 0x0d, 0x0a, 0x1a, 0x0a };
+
+#define LZO_BLOCK_SIZE		(256*1024l)
+
+/* Longest header up to and including the length of the file name */
+#define LZO_HEADER_FIXED	38
+/* Largest block header: sizes and up to two checksums of each kind */
+#define LZO_BLOCK_HEADER	24
+#define LZO_IN_BUF_SIZE		(LZO_BLOCK_SIZE + LZO_BLOCK_HEADER)
+
+#define F_ADLER32_D		0x00000001L
+#define F_ADLER32_C		0x00000002L
+#define F_H_EXTRA_FIELD		0x00000040L
+#define F_CRC32_D		0x00000100L
+#define F_CRC32_C		0x00000200L
+#define F_H_FILTER		0x00000800L
+
+/*
+ * Parse the start of the header, which must be LZO_HEADER_FIXED bytes
+ * long at least.  Returns the length of the whole header, or 0 if this
+ * is not an lzop file we can decompress.
+ */
+static inline int INIT parse_header(u8 *input, u32 *flags)
+{
+	u8 *parse = input;
+	u16 version;
+	u8 method;
+	int l;
+
+	for (l = 0; l < sizeof(lzop_magic); l++) {
+		if (*parse++ != lzop_magic[l])
+			return 0;
+	}
+
+	/* version, then library version */
+	version = get_unaligned_be16(parse);
+	parse += 4;
+	/* version needed to extract */
+	if (version >= 0x0940)
+		parse += 2;
+	method = *parse++;
+	if (method < 1 || method > 3)
+		return 0;
+	/* level */
+	if (version >= 0x0940)
+		parse++;
+
+	*flags = get_unaligned_be32(parse);
+	parse += 4;
+	if (*flags & F_H_EXTRA_FIELD)
+		return 0;
+	if (*flags & F_H_FILTER)
+		parse += 4;
+
+	/* mode and mtime */
+	parse += 8;
+	if (version >= 0x0940)
+		parse += 4;
+
+	/* file name, then header checksum */
+	l = *parse++;
+	parse += l + 4;
+
+	return parse - input;
+}
+
+/*
+ * Make sure @need bytes are available at *@ip.  When the data comes
+ * from @fill, what is left is moved to the start of @buf first.
+ */
+static inline int INIT unlzo_need(u8 *buf, u8 **ip, int *avail, int need,
+				  int (*fill)(void *, unsigned int))
+{
+	int i, n;
+
+	if (*avail >= need)
+		return 1;
+	if (!fill)
+		return 0;
+
+	for (i = 0; i < *avail; i++)
+		buf[i] = (*ip)[i];
+	*ip = buf;
+	while (*avail < need) {
+		n = fill(buf + *avail, LZO_IN_BUF_SIZE - *avail);
+		if (n <= 0)
+			return 0;
+		*avail += n;
+	}
+	return 1;
+}
+
+STATIC int INIT unlzo(u8 *input, int in_len,
+		      int (*fill)(void *, unsigned int),
+		      int (*flush)(void *, unsigned int),
+		      u8 *output, int *posp,
+		      void (*error_fn)(char *x))
+{
+	u8 *in_buf, *ip, *out_buf;
+	u32 flags, src_len, dst_len, skip;
+	int avail, hdr_len, pos = 0;
+	size_t tmp;
+	int r, ret = -1;
+
+	set_error_fn(error_fn);
+
+	if (output) {
+		out_buf = output;
+	} else if (!flush) {
+		error("NULL output pointer and no flush function provided");
+		goto exit;
+	} else {
+		out_buf = malloc(LZO_BLOCK_SIZE);
+		if (!out_buf) {
+			error("Could not allocate output buffer");
+			goto exit;
+		}
+	}
+
+	if (input) {
+		in_buf = input;
+		avail = in_len;
+		fill = NULL;
+	} else if (!fill) {
+		error("NULL input pointer and no fill function provided");
+		goto exit_1;
+	} else {
+		in_buf = malloc(LZO_IN_BUF_SIZE);
+		if (!in_buf) {
+			error("Could not allocate input buffer");
+			goto exit_1;
+		}
+		avail = 0;
+	}
+	ip = in_buf;
+
+	if (!unlzo_need(in_buf, &ip, &avail, LZO_HEADER_FIXED, fill))
+		goto truncated;
+	hdr_len = parse_header(ip, &flags);
+	if (!hdr_len) {
+		error("invalid header");
+		goto exit_2;
+	}
+	if (!unlzo_need(in_buf, &ip, &avail, hdr_len, fill))
+		goto truncated;
+	ip += hdr_len;
+	avail -= hdr_len;
+	pos += hdr_len;
+
+	for (;;) {
+		/* uncompressed size, 0 at the end of the file */
+		if (!unlzo_need(in_buf, &ip, &avail, 4, fill))
+			goto truncated;
+		dst_len = get_unaligned_be32(ip);
+		ip += 4;
+		avail -= 4;
+		pos += 4;
+		if (dst_len == 0)
+			break;
+		if (dst_len > LZO_BLOCK_SIZE) {
+			error("dest len longer than block size");
+			goto exit_2;
+		}
+
+		/* compressed size, then the checksums we do not verify */
+		if (!unlzo_need(in_buf, &ip, &avail, 4, fill))
+			goto truncated;
+		src_len = get_unaligned_be32(ip);
+		if (src_len == 0 || src_len > dst_len) {
+			error("file corrupted");
+			goto exit_2;
+		}
+		skip = 4;
+		if (flags & F_ADLER32_D)
+			skip += 4;
+		if (flags & F_CRC32_D)
+			skip += 4;
+		if (src_len < dst_len) {
+			if (flags & F_ADLER32_C)
+				skip += 4;
+			if (flags & F_CRC32_C)
+				skip += 4;
+		}
+
+		if (!unlzo_need(in_buf, &ip, &avail, skip + src_len, fill))
+			goto truncated;
+		ip += skip;
+
+		if (src_len == dst_len) {
+			/* stored as is */
+			memcpy(out_buf, ip, src_len);
+		} else {
+			tmp = dst_len;
+			r = lzo1x_decompress_safe(ip, src_len, out_buf, &tmp);
+			if (r != LZO_E_OK || tmp != dst_len) {
+				error("Compressed data violation");
+				goto exit_2;
+			}
+		}
+
+		if (flush && flush(out_buf, dst_len) != dst_len) {
+			error("write error");
+			goto exit_2;
+		}
+		if (output)
+			out_buf += dst_len;
+
+		ip += src_len;
+		avail -= skip + src_len;
+		pos += skip + src_len;
+	}
+
+	ret = 0;
+	goto exit_2;
+
+truncated:
+	error("unexpected end of input");
+exit_2:
+	if (posp)
+		*posp = pos;
+	if (!input)
+		free(in_buf);
+exit_1:
+	if (!output)
+		free(out_buf);
+exit:
+	return ret;
+}
+
+#define decompress unlzo
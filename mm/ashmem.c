@@ -317,6 +317,8 @@ static int ashmem_shrink(int nr_to_scan, gfp_t gfp_mask)
 
 static struct shrinker ashmem_shrinker = {
 	.shrink = ashmem_shrink,
+	/* unpinned ranges are the first thing worth dropping early */
+	.soft_reclaim = 1,
 	.seeks = DEFAULT_SEEKS * 4,
 };
 
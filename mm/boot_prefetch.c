@@ -0,0 +1,505 @@
+/*
+ * mm/boot_prefetch.c - record the file pages read during boot, and read
+ * them in ahead of time on the following boots.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Booting reads thousands of small files in an order which hardly changes
+ * from one boot to the next.  With "bootprefetch=record" on the command
+ * line, or after writing 1 to <debugfs>/bootprefetch/record, every page of
+ * a regular file that is read or faulted in is recorded, until 0 is
+ * written to the same file.  The trace can then be read back from
+ * <debugfs>/bootprefetch/trace, one line per file in order of first
+ * access:
+ *
+ *	<start>+<nr>[,<start>+<nr>...] <path>
+ *
+ * with the page ranges in the order they were first touched.  Writing
+ * such a trace back to the same file early on the next boot queues an
+ * async job which opens the files in turn, and reads their ranges in,
+ * sorted and merged, with force_page_cache_readahead().
+ *
+ * See Documentation/vm/boot-prefetch.txt.
+ */
+
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/fs.h>
+#include <linux/mm.h>
+#include <linux/file.h>
+#include <linux/path.h>
+#include <linux/dcache.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/hash.h>
+#include <linux/sort.h>
+#include <linux/async.h>
+#include <linux/debugfs.h>
+#include <linux/uaccess.h>
+
+#include "internal.h"
+
+#define BP_HASH_BITS	8
+#define BP_MAX_RUNS	16384
+#define BP_MAX_TRACE	(1024 * 1024)	/* bytes of trace text */
+#define BP_MAX_RANGES	(PAGE_SIZE / sizeof(struct bp_range))
+#define BP_MERGE_GAP	4		/* holes (in pages) read anyway */
+
+/* A file seen while recording; holds a reference to its path. */
+struct bp_file {
+	struct list_head list;		/* in bp_files, by first access */
+	struct hlist_node hash;		/* in bp_hash, by inode */
+	struct path path;
+	int first_run, last_run;	/* indexes in bp_runs, or -1 */
+};
+
+/* A range of pages of a file, accessed in a row. */
+struct bp_run {
+	struct bp_file *file;
+	pgoff_t start;
+	unsigned long nr;
+	int next;			/* next run of the same file, or -1 */
+};
+
+struct bp_range {
+	pgoff_t start;
+	unsigned long nr;
+};
+
+/* Contents of a trace being written by userspace. */
+struct bp_input {
+	char *buf;
+	size_t len;
+};
+
+int boot_prefetch_recording __read_mostly;
+static int bp_record_at_boot __initdata;
+
+/* Protects the recording state below. */
+static DEFINE_SPINLOCK(bp_lock);
+static LIST_HEAD(bp_files);
+static struct hlist_head bp_hash[1 << BP_HASH_BITS];
+static struct bp_run *bp_runs;
+static int bp_nr_runs;
+static unsigned long bp_dropped;
+
+/* Serializes recording start/stop, and protects the trace text. */
+static DEFINE_MUTEX(bp_mutex);
+static char *bp_trace;
+static size_t bp_trace_len;
+
+/*
+ * Replays are kept out of the default async domain, so that module
+ * loading and the like don't wait for them with async_synchronize_full().
+ */
+static LIST_HEAD(bp_async_domain);
+
+void __boot_prefetch_record(struct file *filp, pgoff_t index)
+{
+	struct inode *inode = filp->f_path.dentry->d_inode;
+	struct hlist_head *head;
+	struct hlist_node *n;
+	struct bp_file *bf;
+	struct bp_run *run;
+
+	if (!S_ISREG(inode->i_mode))
+		return;
+
+	spin_lock(&bp_lock);
+	if (!boot_prefetch_recording)
+		goto out;
+
+	head = &bp_hash[hash_ptr(inode, BP_HASH_BITS)];
+	hlist_for_each_entry(bf, n, head, hash)
+		if (bf->path.dentry->d_inode == inode)
+			goto found;
+
+	bf = kmalloc(sizeof(*bf), GFP_ATOMIC);
+	if (!bf) {
+		bp_dropped++;
+		goto out;
+	}
+	bf->path = filp->f_path;
+	path_get(&bf->path);
+	bf->first_run = bf->last_run = -1;
+	list_add_tail(&bf->list, &bp_files);
+	hlist_add_head(&bf->hash, head);
+
+found:
+	/* Extend the last run of the file if it is sequential. */
+	if (bf->last_run >= 0) {
+		run = &bp_runs[bf->last_run];
+		if (index >= run->start && index <= run->start + run->nr) {
+			if (index == run->start + run->nr)
+				run->nr++;
+			goto out;
+		}
+	}
+
+	if (bp_nr_runs == BP_MAX_RUNS) {
+		bp_dropped++;
+		goto out;
+	}
+	run = &bp_runs[bp_nr_runs];
+	run->file = bf;
+	run->start = index;
+	run->nr = 1;
+	run->next = -1;
+	if (bf->last_run >= 0)
+		bp_runs[bf->last_run].next = bp_nr_runs;
+	else
+		bf->first_run = bp_nr_runs;
+	bf->last_run = bp_nr_runs++;
+out:
+	spin_unlock(&bp_lock);
+}
+
+static int bp_start_recording(void)
+{
+	struct bp_run *runs;
+
+	runs = vmalloc(BP_MAX_RUNS * sizeof(*runs));
+	if (!runs)
+		return -ENOMEM;
+
+	spin_lock(&bp_lock);
+	if (boot_prefetch_recording) {
+		spin_unlock(&bp_lock);
+		vfree(runs);
+		return -EBUSY;
+	}
+	bp_runs = runs;
+	bp_nr_runs = 0;
+	bp_dropped = 0;
+	boot_prefetch_recording = 1;
+	spin_unlock(&bp_lock);
+
+	return 0;
+}
+
+/*
+ * Print one line of the trace into buf and return its length: 0 if the
+ * file is skipped, -ENOSPC if the line doesn't fit in size bytes.
+ */
+static int bp_format_file(char *buf, size_t size, struct bp_file *bf,
+			  struct bp_run *runs, char *pathbuf)
+{
+	size_t len = 0;
+	char *p;
+	int i;
+
+	if (d_unlinked(bf->path.dentry))
+		return 0;
+	p = d_path(&bf->path, pathbuf, PATH_MAX);
+	if (IS_ERR(p) || strchr(p, '\n'))
+		return 0;
+
+	for (i = bf->first_run; i >= 0; i = runs[i].next)
+		len += scnprintf(buf + len, size - len, "%s%lu+%lu",
+				 i == bf->first_run ? "" : ",",
+				 runs[i].start, runs[i].nr);
+	len += scnprintf(buf + len, size - len, " %s\n", p);
+
+	/* scnprintf() stops one short of size when it truncates. */
+	if (len >= size - 1)
+		return -ENOSPC;
+
+	return len;
+}
+
+static int bp_stop_recording(void)
+{
+	struct bp_file *bf, *tmp;
+	LIST_HEAD(files);
+	struct bp_run *runs;
+	unsigned long dropped;
+	char *pathbuf, *trace;
+	size_t len = 0;
+	int i, nr_runs;
+
+	spin_lock(&bp_lock);
+	if (!boot_prefetch_recording) {
+		spin_unlock(&bp_lock);
+		return -EINVAL;
+	}
+	boot_prefetch_recording = 0;
+	list_splice_init(&bp_files, &files);
+	for (i = 0; i < ARRAY_SIZE(bp_hash); i++)
+		INIT_HLIST_HEAD(&bp_hash[i]);
+	runs = bp_runs;
+	nr_runs = bp_nr_runs;
+	dropped = bp_dropped;
+	bp_runs = NULL;
+	spin_unlock(&bp_lock);
+
+	trace = vmalloc(BP_MAX_TRACE);
+	pathbuf = __getname();
+	if (trace && pathbuf) {
+		list_for_each_entry(bf, &files, list) {
+			int n = bp_format_file(trace + len, BP_MAX_TRACE - len,
+					       bf, runs, pathbuf);
+			if (n < 0)
+				break;
+			len += n;
+		}
+	}
+	if (pathbuf)
+		__putname(pathbuf);
+
+	list_for_each_entry_safe(bf, tmp, &files, list) {
+		path_put(&bf->path);
+		kfree(bf);
+	}
+	vfree(runs);
+
+	if (!trace)
+		return -ENOMEM;
+
+	vfree(bp_trace);
+	bp_trace = trace;
+	bp_trace_len = len;
+
+	printk(KERN_INFO "bootprefetch: recorded %d page ranges, %lu dropped\n",
+	       nr_runs, dropped);
+
+	return 0;
+}
+
+static int bp_range_cmp(const void *a, const void *b)
+{
+	const struct bp_range *ra = a, *rb = b;
+
+	if (ra->start < rb->start)
+		return -1;
+	return ra->start > rb->start;
+}
+
+/*
+ * Parse "<start>+<nr>[,<start>+<nr>...]" into ranges, then sort them and
+ * merge those that overlap or are at most BP_MERGE_GAP pages apart.
+ */
+static int bp_parse_ranges(char *s, struct bp_range *ranges)
+{
+	int i, j, nr = 0;
+	char *end;
+
+	while (*s && nr < BP_MAX_RANGES) {
+		ranges[nr].start = simple_strtoul(s, &end, 10);
+		if (*end != '+')
+			return 0;
+		ranges[nr].nr = simple_strtoul(end + 1, &end, 10);
+		if (*end && *end != ',')
+			return 0;
+		if (ranges[nr].nr)
+			nr++;
+		s = *end ? end + 1 : end;
+	}
+	if (!nr)
+		return 0;
+
+	sort(ranges, nr, sizeof(*ranges), bp_range_cmp, NULL);
+
+	for (i = 1, j = 0; i < nr; i++) {
+		struct bp_range *last = &ranges[j];
+
+		if (ranges[i].start <= last->start + last->nr + BP_MERGE_GAP)
+			last->nr = max(last->nr, ranges[i].start +
+				       ranges[i].nr - last->start);
+		else
+			ranges[++j] = ranges[i];
+	}
+
+	return j + 1;
+}
+
+static void bp_replay(void *data, async_cookie_t cookie)
+{
+	char *trace = data, *line, *next, *path;
+	unsigned long files = 0, pages = 0;
+	struct bp_range *ranges;
+	struct file *filp;
+	int i, nr, ret;
+
+	ranges = kmalloc(BP_MAX_RANGES * sizeof(*ranges), GFP_KERNEL);
+	if (!ranges)
+		goto out;
+
+	for (line = trace; line && *line; line = next) {
+		next = strchr(line, '\n');
+		if (next)
+			*next++ = '\0';
+
+		path = strchr(line, ' ');
+		if (!path)
+			continue;
+		*path++ = '\0';
+
+		nr = bp_parse_ranges(line, ranges);
+		if (!nr)
+			continue;
+
+		filp = filp_open(path, O_RDONLY | O_LARGEFILE, 0);
+		if (IS_ERR(filp))
+			continue;
+
+		for (i = 0; i < nr; i++) {
+			ret = force_page_cache_readahead(filp->f_mapping, filp,
+							 ranges[i].start,
+							 ranges[i].nr);
+			if (ret < 0)
+				break;
+			pages += ret;
+		}
+		filp_close(filp, NULL);
+		files++;
+	}
+
+	kfree(ranges);
+	printk(KERN_INFO "bootprefetch: read %lu pages from %lu files\n",
+	       pages, files);
+out:
+	vfree(trace);
+}
+
+static ssize_t bp_record_read(struct file *file, char __user *buf,
+			      size_t count, loff_t *ppos)
+{
+	char val[3];
+
+	val[0] = boot_prefetch_recording ? '1' : '0';
+	val[1] = '\n';
+	val[2] = '\0';
+
+	return simple_read_from_buffer(buf, count, ppos, val, 2);
+}
+
+static ssize_t bp_record_write(struct file *file, const char __user *buf,
+			       size_t count, loff_t *ppos)
+{
+	char val;
+	int ret;
+
+	if (!count)
+		return 0;
+	if (get_user(val, buf))
+		return -EFAULT;
+
+	mutex_lock(&bp_mutex);
+	if (val == '1')
+		ret = bp_start_recording();
+	else if (val == '0')
+		ret = bp_stop_recording();
+	else
+		ret = -EINVAL;
+	mutex_unlock(&bp_mutex);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations bp_record_fops = {
+	.read =		bp_record_read,
+	.write =	bp_record_write,
+};
+
+static int bp_trace_open(struct inode *inode, struct file *file)
+{
+	struct bp_input *in;
+
+	if (!(file->f_mode & FMODE_WRITE))
+		return 0;
+
+	in = kmalloc(sizeof(*in), GFP_KERNEL);
+	if (!in)
+		return -ENOMEM;
+	in->buf = vmalloc(BP_MAX_TRACE + 1);
+	if (!in->buf) {
+		kfree(in);
+		return -ENOMEM;
+	}
+	in->len = 0;
+	file->private_data = in;
+
+	return 0;
+}
+
+static ssize_t bp_trace_read(struct file *file, char __user *buf,
+			     size_t count, loff_t *ppos)
+{
+	ssize_t ret;
+
+	mutex_lock(&bp_mutex);
+	ret = simple_read_from_buffer(buf, count, ppos, bp_trace,
+				      bp_trace_len);
+	mutex_unlock(&bp_mutex);
+
+	return ret;
+}
+
+static ssize_t bp_trace_write(struct file *file, const char __user *buf,
+			      size_t count, loff_t *ppos)
+{
+	struct bp_input *in = file->private_data;
+
+	if (count > BP_MAX_TRACE - in->len)
+		return -EFBIG;
+	if (copy_from_user(in->buf + in->len, buf, count))
+		return -EFAULT;
+	in->len += count;
+
+	return count;
+}
+
+/* A trace is replayed once it has been written in full. */
+static int bp_trace_release(struct inode *inode, struct file *file)
+{
+	struct bp_input *in = file->private_data;
+
+	if (!in)
+		return 0;
+
+	if (in->len) {
+		in->buf[in->len] = '\0';
+		async_schedule_domain(bp_replay, in->buf, &bp_async_domain);
+	} else
+		vfree(in->buf);
+	kfree(in);
+
+	return 0;
+}
+
+static const struct file_operations bp_trace_fops = {
+	.open =		bp_trace_open,
+	.read =		bp_trace_read,
+	.write =	bp_trace_write,
+	.release =	bp_trace_release,
+};
+
+static int __init bp_setup(char *str)
+{
+	if (!strcmp(str, "record"))
+		bp_record_at_boot = 1;
+	return 1;
+}
+__setup("bootprefetch=", bp_setup);
+
+static int __init boot_prefetch_init(void)
+{
+	struct dentry *dir;
+
+	dir = debugfs_create_dir("bootprefetch", NULL);
+	if (!dir)
+		return -ENOMEM;
+	debugfs_create_file("record", S_IRUSR | S_IWUSR, dir, NULL,
+			    &bp_record_fops);
+	debugfs_create_file("trace", S_IRUSR | S_IWUSR, dir, NULL,
+			    &bp_trace_fops);
+
+	if (bp_record_at_boot)
+		bp_start_recording();
+
+	return 0;
+}
+fs_initcall(boot_prefetch_init);
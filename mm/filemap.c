@@ -110,16 +110,41 @@
  *    ->i_mmap_lock
  */
 
+static void page_cache_tree_delete(struct address_space *mapping,
+				   struct page *page, void *shadow)
+{
+	void **slot;
+	int tag;
+
+	if (!shadow) {
+		radix_tree_delete(&mapping->page_tree, page->index);
+		return;
+	}
+
+	/*
+	 * Reclaim only evicts clean pages that are not under writeback,
+	 * but a stale tag must not be left on the shadow entry.
+	 */
+	for (tag = 0; tag < RADIX_TREE_MAX_TAGS; tag++)
+		if (radix_tree_tagged(&mapping->page_tree, tag))
+			radix_tree_tag_clear(&mapping->page_tree,
+					     page->index, tag);
+	slot = radix_tree_lookup_slot(&mapping->page_tree, page->index);
+	radix_tree_replace_slot(slot, shadow);
+	mapping->nrshadows++;
+}
+
 /*
  * Remove a page from the page cache and free it. Caller has to make
  * sure the page is locked and that nobody else uses it - or that usage
- * is safe.  The caller must hold the mapping's tree_lock.
+ * is safe.  The caller must hold the mapping's tree_lock.  If @shadow
+ * is not NULL, it is left in the page's slot (see mm/workingset.c).
  */
-void __remove_from_page_cache(struct page *page)
+void __remove_from_page_cache(struct page *page, void *shadow)
 {
 	struct address_space *mapping = page->mapping;
 
-	radix_tree_delete(&mapping->page_tree, page->index);
+	page_cache_tree_delete(mapping, page, shadow);
 	page->mapping = NULL;
 	mapping->nrpages--;
 	__dec_zone_page_state(page, NR_FILE_PAGES);
@@ -147,7 +172,7 @@ void remove_from_page_cache(struct page *page)
 	BUG_ON(!PageLocked(page));
 
 	spin_lock_irq(&mapping->tree_lock);
-	__remove_from_page_cache(page);
+	__remove_from_page_cache(page, NULL);
 	spin_unlock_irq(&mapping->tree_lock);
 	mem_cgroup_uncharge_cache_page(page);
 }
@@ -404,18 +429,29 @@ int filemap_write_and_wait_range(struct address_space *mapping,
 }
 EXPORT_SYMBOL(filemap_write_and_wait_range);
 
-/**
- * add_to_page_cache_locked - add a locked page to the pagecache
- * @page:	page to add
- * @mapping:	the page's address_space
- * @offset:	page index
- * @gfp_mask:	page allocation mode
- *
- * This function is used to add a page to the pagecache. It must be locked.
- * This function does not add the page to the LRU.  The caller must do that.
- */
-int add_to_page_cache_locked(struct page *page, struct address_space *mapping,
-		pgoff_t offset, gfp_t gfp_mask)
+static int page_cache_tree_insert(struct address_space *mapping,
+				  struct page *page, void **shadowp)
+{
+	void **slot;
+	void *p;
+
+	slot = radix_tree_lookup_slot(&mapping->page_tree, page->index);
+	if (!slot)
+		return radix_tree_insert(&mapping->page_tree, page->index, page);
+
+	p = radix_tree_deref_slot(slot);
+	if (!radix_tree_exceptional_entry(p))
+		return -EEXIST;
+	radix_tree_replace_slot(slot, page);
+	mapping->nrshadows--;
+	if (shadowp)
+		*shadowp = p;
+	return 0;
+}
+
+static int __add_to_page_cache_locked(struct page *page,
+		struct address_space *mapping, pgoff_t offset, gfp_t gfp_mask,
+		void **shadowp)
 {
 	int error;
 
@@ -433,7 +469,7 @@ int add_to_page_cache_locked(struct page *page, struct address_space *mapping,
 		page->index = offset;
 
 		spin_lock_irq(&mapping->tree_lock);
-		error = radix_tree_insert(&mapping->page_tree, offset, page);
+		error = page_cache_tree_insert(mapping, page, shadowp);
 		if (likely(!error)) {
 			mapping->nrpages++;
 			__inc_zone_page_state(page, NR_FILE_PAGES);
@@ -452,11 +488,28 @@ int add_to_page_cache_locked(struct page *page, struct address_space *mapping,
 out:
 	return error;
 }
+
+/**
+ * add_to_page_cache_locked - add a locked page to the pagecache
+ * @page:	page to add
+ * @mapping:	the page's address_space
+ * @offset:	page index
+ * @gfp_mask:	page allocation mode
+ *
+ * This function is used to add a page to the pagecache. It must be locked.
+ * This function does not add the page to the LRU.  The caller must do that.
+ */
+int add_to_page_cache_locked(struct page *page, struct address_space *mapping,
+		pgoff_t offset, gfp_t gfp_mask)
+{
+	return __add_to_page_cache_locked(page, mapping, offset, gfp_mask, NULL);
+}
 EXPORT_SYMBOL(add_to_page_cache_locked);
 
 int add_to_page_cache_lru(struct page *page, struct address_space *mapping,
 				pgoff_t offset, gfp_t gfp_mask)
 {
+	void *shadow = NULL;
 	int ret;
 
 	/*
@@ -468,13 +521,23 @@ int add_to_page_cache_lru(struct page *page, struct address_space *mapping,
 	if (mapping_cap_swap_backed(mapping))
 		SetPageSwapBacked(page);
 
-	ret = add_to_page_cache(page, mapping, offset, gfp_mask);
-	if (ret == 0) {
-		if (page_is_file_cache(page))
+	__set_page_locked(page);
+	ret = __add_to_page_cache_locked(page, mapping, offset, gfp_mask,
+					 &shadow);
+	if (unlikely(ret)) {
+		__clear_page_locked(page);
+	} else if (page_is_file_cache(page)) {
+		/*
+		 * A page that was evicted recently enough is part of the
+		 * working set: it goes straight to the active list.
+		 */
+		if (shadow && workingset_refault(shadow)) {
+			lru_cache_add_active_file(page);
+			workingset_activation(page);
+		} else
 			lru_cache_add_file(page);
-		else
-			lru_cache_add_active_anon(page);
-	}
+	} else
+		lru_cache_add_active_anon(page);
 	return ret;
 }
 EXPORT_SYMBOL_GPL(add_to_page_cache_lru);
@@ -647,6 +710,11 @@ repeat:
 		page = radix_tree_deref_slot(pagep);
 		if (unlikely(!page || page == RADIX_TREE_RETRY))
 			goto repeat;
+		/* A shadow entry of an evicted page is a miss */
+		if (radix_tree_exceptional_entry(page)) {
+			page = NULL;
+			goto out;
+		}
 
 		if (!page_cache_get_speculative(page))
 			goto repeat;
@@ -661,6 +729,7 @@ repeat:
 			goto repeat;
 		}
 	}
+out:
 	rcu_read_unlock();
 
 	return page;
@@ -763,39 +832,56 @@ EXPORT_SYMBOL(find_or_create_page);
 unsigned find_get_pages(struct address_space *mapping, pgoff_t start,
 			    unsigned int nr_pages, struct page **pages)
 {
+	void **slots[PAGEVEC_SIZE];
+	unsigned long indices[PAGEVEC_SIZE];
 	unsigned int i;
-	unsigned int ret;
-	unsigned int nr_found;
+	unsigned int ret = 0;
+	unsigned int nr_found, batch;
 
+	/*
+	 * Look up at most PAGEVEC_SIZE slots at a time, so that a run of
+	 * shadow entries can be skipped: callers take 0 to mean that there
+	 * are no more pages.
+	 */
 	rcu_read_lock();
+	while (ret < nr_pages) {
+		batch = min_t(unsigned int, nr_pages - ret, PAGEVEC_SIZE);
 restart:
-	nr_found = radix_tree_gang_lookup_slot(&mapping->page_tree,
-				(void ***)pages, start, nr_pages);
-	ret = 0;
-	for (i = 0; i < nr_found; i++) {
-		struct page *page;
+		nr_found = radix_tree_gang_lookup_slot(&mapping->page_tree,
+				slots, indices, start, batch);
+		if (!nr_found)
+			break;
+		for (i = 0; i < nr_found; i++) {
+			struct page *page;
 repeat:
-		page = radix_tree_deref_slot((void **)pages[i]);
-		if (unlikely(!page))
-			continue;
-		/*
-		 * this can only trigger if nr_found == 1, making livelock
-		 * a non issue.
-		 */
-		if (unlikely(page == RADIX_TREE_RETRY))
-			goto restart;
+			page = radix_tree_deref_slot(slots[i]);
+			if (unlikely(!page))
+				continue;
+			/*
+			 * this can only trigger if nr_found == 1, making
+			 * livelock a non issue.
+			 */
+			if (unlikely(page == RADIX_TREE_RETRY))
+				goto restart;
+			/* Skip the shadow entries of evicted pages */
+			if (radix_tree_exceptional_entry(page))
+				continue;
 
-		if (!page_cache_get_speculative(page))
-			goto repeat;
+			if (!page_cache_get_speculative(page))
+				goto repeat;
 
-		/* Has the page moved? */
-		if (unlikely(page != *((void **)pages[i]))) {
-			page_cache_release(page);
-			goto repeat;
-		}
+			/* Has the page moved? */
+			if (unlikely(page != *slots[i])) {
+				page_cache_release(page);
+				goto repeat;
+			}
 
-		pages[ret] = page;
-		ret++;
+			pages[ret] = page;
+			ret++;
+		}
+		start = indices[nr_found - 1] + 1;
+		if (!start || nr_found < batch)
+			break;
 	}
 	rcu_read_unlock();
 	return ret;
@@ -823,7 +909,7 @@ unsigned find_get_pages_contig(struct address_space *mapping, pgoff_t index,
 	rcu_read_lock();
 restart:
 	nr_found = radix_tree_gang_lookup_slot(&mapping->page_tree,
-				(void ***)pages, index, nr_pages);
+				(void ***)pages, NULL, index, nr_pages);
 	ret = 0;
 	for (i = 0; i < nr_found; i++) {
 		struct page *page;
@@ -837,6 +923,9 @@ repeat:
 		 */
 		if (unlikely(page == RADIX_TREE_RETRY))
 			goto restart;
+		/* A shadow entry is a hole */
+		if (radix_tree_exceptional_entry(page))
+			break;
 
 		if (page->mapping == NULL || page->index != index)
 			break;
@@ -1009,6 +1098,8 @@ static void do_generic_file_read(struct file *filp, loff_t *ppos,
 		unsigned long nr, ret;
 
 		cond_resched();
+		ra_trace_record(filp, index);
+		boot_prefetch_record(filp, index);
 find_page:
 		page = find_get_page(mapping, index);
 		if (!page) {
@@ -1511,6 +1602,9 @@ int filemap_fault(struct vm_area_struct *vma, struct vm_fault *vmf)
 	if (offset >= size)
 		return VM_FAULT_SIGBUS;
 
+	ra_trace_record(file, offset);
+	boot_prefetch_record(file, offset);
+
 	/*
 	 * Do we have something in the page cache already?
 	 */
@@ -12,6 +12,7 @@
 #define __MM_INTERNAL_H
 
 #include <linux/mm.h>
+#include <linux/fs.h>
 
 void free_pgtables(struct mmu_gather *tlb, struct vm_area_struct *start_vma,
 		unsigned long floor, unsigned long ceiling);
@@ -260,4 +261,41 @@ int __get_user_pages(struct task_struct *tsk, struct mm_struct *mm,
 #define ZONE_RECLAIM_FULL	-1
 #define ZONE_RECLAIM_SOME	0
 #define ZONE_RECLAIM_SUCCESS	1
+
+#ifdef CONFIG_READAHEAD_TRACE
+extern void __ra_trace_record(struct file *filp, pgoff_t index);
+
+/*
+ * Note an access to page @index of @filp, if its accesses are being
+ * recorded.
+ */
+static inline void ra_trace_record(struct file *filp, pgoff_t index)
+{
+	if (unlikely(filp->f_ra_trace))
+		__ra_trace_record(filp, index);
+}
+#else
+static inline void ra_trace_record(struct file *filp, pgoff_t index)
+{
+}
+#endif
+
+#ifdef CONFIG_BOOT_PREFETCH
+extern int boot_prefetch_recording;
+extern void __boot_prefetch_record(struct file *filp, pgoff_t index);
+
+/*
+ * Note an access to page @index of @filp in the boot trace, if one is
+ * being recorded.
+ */
+static inline void boot_prefetch_record(struct file *filp, pgoff_t index)
+{
+	if (unlikely(boot_prefetch_recording))
+		__boot_prefetch_record(filp, index);
+}
+#else
+static inline void boot_prefetch_record(struct file *filp, pgoff_t index)
+{
+}
+#endif
 #endif
@@ -32,6 +32,7 @@
 #include <linux/mmu_notifier.h>
 #include <linux/swap.h>
 #include <linux/ksm.h>
+#include <linux/math64.h>
 
 #include <asm/tlbflush.h>
 #include "internal.h"
@@ -133,6 +134,8 @@ struct rmap_item {
 #define SEQNR_MASK	0x0ff	/* low bits of unstable tree seqnr */
 #define NODE_FLAG	0x100	/* is a node of unstable or stable tree */
 #define STABLE_FLAG	0x200	/* is a node or list item of stable tree */
+#define SKIP_MASK	0xc00	/* sampling: page checked 1 in 2^skip scans */
+#define SKIP_SHIFT	10
 
 /* The stable and unstable tree heads */
 static struct rb_root root_stable_tree = RB_ROOT;
@@ -172,6 +175,33 @@ static unsigned int ksm_thread_pages_to_scan = 100;
 /* Milliseconds ksmd should sleep between batches */
 static unsigned int ksm_thread_sleep_millisecs = 20;
 
+/*
+ * Sampling mode: checksum a sample of each page's words, check volatile
+ * pages less often, and adapt the sleep between batches to merge yield.
+ */
+static unsigned int ksm_sampling;
+
+/* Longest sleep between batches when sampling finds nothing to merge */
+static unsigned int ksm_sleep_max_millisecs = 1000;
+
+/* Sleep between batches currently chosen by sampling mode */
+static unsigned int ksm_sleep_cur_millisecs = 20;
+
+/* Merges per 1000 pages scanned above which ksmd speeds up, and below
+ * which it slows down */
+#define KSM_YIELD_HIGH	10
+#define KSM_YIELD_LOW	1
+
+/* Pages checked and merged during the current full scan */
+static unsigned long ksm_scan_checked;
+static unsigned long ksm_scan_merged;
+
+/* Pages checked, and pages skipped by sampling mode, since boot */
+static unsigned long ksm_pages_scanned;
+static unsigned long ksm_pages_skipped;
+
+static struct task_struct *ksm_thread;
+
 #define KSM_RUN_STOP	0
 #define KSM_RUN_MERGE	1
 #define KSM_RUN_UNMERGE	2
@@ -471,7 +501,7 @@ static void remove_rmap_item_from_tree(struct rmap_item *rmap_item)
 		ksm_pages_unshared--;
 	}
 
-	rmap_item->address &= PAGE_MASK;
+	rmap_item->address &= PAGE_MASK | SKIP_MASK;
 
 	cond_resched();		/* we're called from many long loops */
 }
@@ -583,15 +613,83 @@ error:
 }
 #endif /* CONFIG_SYSFS */
 
+/*
+ * In sampling mode only KSM_SAMPLE_WORDS words of the page are hashed, one
+ * from each stretch of the page, at a different offset in each stretch.
+ * The checksum only decides whether a page looks stable enough to go into
+ * the unstable tree: pages are still compared in full before merging.
+ */
+#define KSM_SAMPLE_WORDS	64
+#define KSM_SAMPLE_STRIDE	(PAGE_SIZE / 4 / KSM_SAMPLE_WORDS)
+
 static u32 calc_checksum(struct page *page)
 {
 	u32 checksum;
-	void *addr = kmap_atomic(page, KM_USER0);
-	checksum = jhash2(addr, PAGE_SIZE / 4, 17);
+	u32 *addr = kmap_atomic(page, KM_USER0);
+
+	if (ksm_sampling) {
+		u32 sample[KSM_SAMPLE_WORDS];
+		int i;
+
+		for (i = 0; i < KSM_SAMPLE_WORDS; i++)
+			sample[i] = addr[i * KSM_SAMPLE_STRIDE +
+					 (i & (KSM_SAMPLE_STRIDE - 1))];
+		checksum = jhash2(sample, KSM_SAMPLE_WORDS, 17);
+	} else
+		checksum = jhash2(addr, PAGE_SIZE / 4, 17);
 	kunmap_atomic(addr, KM_USER0);
 	return checksum;
 }
 
+static inline unsigned int rmap_item_skip(struct rmap_item *rmap_item)
+{
+	return (rmap_item->address & SKIP_MASK) >> SKIP_SHIFT;
+}
+
+static inline void set_rmap_item_skip(struct rmap_item *rmap_item,
+				      unsigned int skip)
+{
+	rmap_item->address &= ~SKIP_MASK;
+	rmap_item->address |= skip << SKIP_SHIFT;
+}
+
+/*
+ * Sampling mode: a page whose checksum keeps changing is only checked
+ * once every 2, 4 and then 8 full scans.  It goes back to every scan as
+ * soon as it is found unchanged.
+ */
+static inline int sampling_skip(struct rmap_item *rmap_item)
+{
+	unsigned int skip = rmap_item_skip(rmap_item);
+
+	return ksm_sampling && skip &&
+		(ksm_scan.seqnr & ((1UL << skip) - 1));
+}
+
+/*
+ * Sampling mode: at the end of each full scan, sleep longer between
+ * batches if few of the pages checked could be merged, shorter if many.
+ */
+static void ksm_adapt_sleep(void)
+{
+	unsigned long yield = 0;
+	unsigned int msecs = ksm_sleep_cur_millisecs;
+
+	if (ksm_scan_checked)
+		yield = ksm_scan_merged * 1000 / ksm_scan_checked;
+
+	if (yield >= KSM_YIELD_HIGH)
+		msecs /= 2;
+	else if (yield < KSM_YIELD_LOW)
+		msecs = msecs ? msecs * 2 : 1;
+	ksm_sleep_cur_millisecs = clamp(msecs, ksm_thread_sleep_millisecs,
+			max(ksm_thread_sleep_millisecs,
+			    ksm_sleep_max_millisecs));
+
+	ksm_scan_checked = 0;
+	ksm_scan_merged = 0;
+}
+
 static int memcmp_pages(struct page *page1, struct page *page2)
 {
 	char *addr1, *addr2;
@@ -1068,6 +1166,7 @@ static void stable_tree_append(struct rmap_item *rmap_item,
 	rmap_item->address |= STABLE_FLAG;
 
 	ksm_pages_sharing++;
+	ksm_scan_merged++;
 }
 
 /*
@@ -1128,8 +1227,12 @@ static void cmp_and_merge_page(struct page *page, struct rmap_item *rmap_item)
 	checksum = calc_checksum(page);
 	if (rmap_item->oldchecksum != checksum) {
 		rmap_item->oldchecksum = checksum;
+		if (ksm_sampling && rmap_item_skip(rmap_item) < 3)
+			set_rmap_item_skip(rmap_item,
+					   rmap_item_skip(rmap_item) + 1);
 		return;
 	}
+	set_rmap_item_skip(rmap_item, 0);
 
 	tree_rmap_item = unstable_tree_search_insert(page, page2, rmap_item);
 	if (tree_rmap_item) {
@@ -1304,6 +1407,8 @@ next_mm:
 		goto next_mm;
 
 	ksm_scan.seqnr++;
+	if (ksm_sampling)
+		ksm_adapt_sleep();
 	return NULL;
 }
 
@@ -1315,12 +1420,23 @@ static void ksm_do_scan(unsigned int scan_npages)
 {
 	struct rmap_item *rmap_item;
 	struct page *page;
+	/* a page skipped by sampling counts as a quarter of one checked */
+	unsigned long budget = 4UL * scan_npages;
 
-	while (scan_npages--) {
+	while (budget >= 4) {
 		cond_resched();
 		rmap_item = scan_get_next_rmap_item(&page);
 		if (!rmap_item)
 			return;
+		if (!in_stable_tree(rmap_item) && sampling_skip(rmap_item)) {
+			put_page(page);
+			ksm_pages_skipped++;
+			budget--;
+			continue;
+		}
+		budget -= 4;
+		ksm_pages_scanned++;
+		ksm_scan_checked++;
 		if (!PageKsm(page) || !in_stable_tree(rmap_item))
 			cmp_and_merge_page(page, rmap_item);
 		else if (page_mapcount(page) == 1) {
@@ -1352,7 +1468,9 @@ static int ksm_scan_thread(void *nothing)
 
 		if (ksmd_should_run()) {
 			schedule_timeout_interruptible(
-				msecs_to_jiffies(ksm_thread_sleep_millisecs));
+				msecs_to_jiffies(ksm_sampling ?
+						 ksm_sleep_cur_millisecs :
+						 ksm_thread_sleep_millisecs));
 		} else {
 			wait_event_interruptible(ksm_thread_wait,
 				ksmd_should_run() || kthread_should_stop());
@@ -1502,11 +1620,73 @@ static ssize_t sleep_millisecs_store(struct kobject *kobj,
 		return -EINVAL;
 
 	ksm_thread_sleep_millisecs = msecs;
+	ksm_sleep_cur_millisecs = msecs;
 
 	return count;
 }
 KSM_ATTR(sleep_millisecs);
 
+static ssize_t sampling_show(struct kobject *kobj,
+			     struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_sampling);
+}
+
+static ssize_t sampling_store(struct kobject *kobj,
+			      struct kobj_attribute *attr,
+			      const char *buf, size_t count)
+{
+	unsigned long sampling;
+	int err;
+
+	err = strict_strtoul(buf, 10, &sampling);
+	if (err || sampling > 1)
+		return -EINVAL;
+
+	mutex_lock(&ksm_thread_mutex);
+	if (ksm_sampling != sampling) {
+		ksm_sampling = sampling;
+		ksm_sleep_cur_millisecs = ksm_thread_sleep_millisecs;
+		ksm_scan_checked = 0;
+		ksm_scan_merged = 0;
+	}
+	mutex_unlock(&ksm_thread_mutex);
+
+	return count;
+}
+KSM_ATTR(sampling);
+
+static ssize_t sleep_max_millisecs_show(struct kobject *kobj,
+					struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_sleep_max_millisecs);
+}
+
+static ssize_t sleep_max_millisecs_store(struct kobject *kobj,
+					 struct kobj_attribute *attr,
+					 const char *buf, size_t count)
+{
+	unsigned long msecs;
+	int err;
+
+	err = strict_strtoul(buf, 10, &msecs);
+	if (err || msecs > UINT_MAX)
+		return -EINVAL;
+
+	ksm_sleep_max_millisecs = msecs;
+
+	return count;
+}
+KSM_ATTR(sleep_max_millisecs);
+
+static ssize_t sleep_cur_millisecs_show(struct kobject *kobj,
+					struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_sampling ? ksm_sleep_cur_millisecs :
+						   ksm_thread_sleep_millisecs);
+}
+KSM_ATTR_RO(sleep_cur_millisecs);
+
 static ssize_t pages_to_scan_show(struct kobject *kobj,
 				  struct kobj_attribute *attr, char *buf)
 {
@@ -1645,8 +1825,33 @@ static ssize_t full_scans_show(struct kobject *kobj,
 }
 KSM_ATTR_RO(full_scans);
 
+static ssize_t pages_scanned_show(struct kobject *kobj,
+				  struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", ksm_pages_scanned);
+}
+KSM_ATTR_RO(pages_scanned);
+
+static ssize_t pages_skipped_show(struct kobject *kobj,
+				  struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", ksm_pages_skipped);
+}
+KSM_ATTR_RO(pages_skipped);
+
+static ssize_t cpu_msecs_show(struct kobject *kobj,
+			      struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%llu\n",
+		       div_u64(task_sched_runtime(ksm_thread), NSEC_PER_MSEC));
+}
+KSM_ATTR_RO(cpu_msecs);
+
 static struct attribute *ksm_attrs[] = {
 	&sleep_millisecs_attr.attr,
+	&sampling_attr.attr,
+	&sleep_max_millisecs_attr.attr,
+	&sleep_cur_millisecs_attr.attr,
 	&pages_to_scan_attr.attr,
 	&run_attr.attr,
 	&max_kernel_pages_attr.attr,
@@ -1655,6 +1860,9 @@ static struct attribute *ksm_attrs[] = {
 	&pages_unshared_attr.attr,
 	&pages_volatile_attr.attr,
 	&full_scans_attr.attr,
+	&pages_scanned_attr.attr,
+	&pages_skipped_attr.attr,
+	&cpu_msecs_attr.attr,
 	NULL,
 };
 
@@ -1666,7 +1874,6 @@ static struct attribute_group ksm_attr_group = {
 
 static int __init ksm_init(void)
 {
-	struct task_struct *ksm_thread;
 	int err;
 
 	ksm_max_kernel_pages = totalram_pages / 4;
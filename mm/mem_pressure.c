@@ -0,0 +1,273 @@
+/*
+ * mm/mem_pressure.c
+ *
+ * Memory pressure notification through /dev/mem_pressure.
+ *
+ * Global page reclaim, from kswapd and from direct reclaim, reports the
+ * pages it scanned and the pages it freed.  Every MEM_PRESSURE_WINDOW
+ * scanned pages, the share of scanned pages that could not be freed
+ * gives a pressure level: low while reclaim finds what it looks for,
+ * medium when it has to scan far more than it frees, and critical when
+ * it is close to giving up.  Direct reclaim reaching a high scanning
+ * priority is critical too.  Each level reached is an event that wakes
+ * up the readers of /dev/mem_pressure.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/swap.h>
+#include <linux/uaccess.h>
+#include <linux/wait.h>
+#include <linux/mem_pressure.h>
+
+enum {
+	MEM_PRESSURE_LOW,
+	MEM_PRESSURE_MEDIUM,
+	MEM_PRESSURE_CRITICAL,
+	MEM_PRESSURE_NR_LEVELS,
+};
+
+static const char *mem_pressure_names[MEM_PRESSURE_NR_LEVELS] = {
+	"low",
+	"medium",
+	"critical",
+};
+
+/* Pages to scan before the reclaim efficiency is evaluated */
+#define MEM_PRESSURE_WINDOW	(SWAP_CLUSTER_MAX * 16)
+
+/* Share of the scanned pages that were not freed, in percent */
+#define MEM_PRESSURE_MEDIUM_PCT		60
+#define MEM_PRESSURE_CRITICAL_PCT	95
+
+/*
+ * Direct reclaim that has to go down to this priority, i.e. to scan one
+ * eighth of the LRU lists at once, is about to fail.
+ */
+#define MEM_PRESSURE_CRITICAL_PRIO	3
+
+/* Per open file: the events seen so far and the lowest level of interest */
+struct mem_pressure_file {
+	unsigned long seen[MEM_PRESSURE_NR_LEVELS];
+	int min_level;
+};
+
+static DEFINE_SPINLOCK(mem_pressure_lock);
+static DECLARE_WAIT_QUEUE_HEAD(mem_pressure_wait);
+
+/* All protected by mem_pressure_lock */
+static unsigned long mp_scanned;
+static unsigned long mp_reclaimed;
+/* mp_events[l] counts the events at level l or above */
+static unsigned long mp_events[MEM_PRESSURE_NR_LEVELS];
+
+static void mem_pressure_event(int level)
+{
+	int i;
+
+	spin_lock(&mem_pressure_lock);
+	for (i = 0; i <= level; i++)
+		mp_events[i]++;
+	spin_unlock(&mem_pressure_lock);
+
+	if (waitqueue_active(&mem_pressure_wait))
+		wake_up_interruptible(&mem_pressure_wait);
+}
+
+/*
+ * Called by global reclaim with the number of pages scanned and freed by
+ * one pass over a zone or a zonelist.
+ */
+void mem_pressure_account(unsigned long scanned, unsigned long reclaimed)
+{
+	unsigned long pressure = 0;
+	int level;
+
+	if (!scanned)
+		return;
+
+	spin_lock(&mem_pressure_lock);
+	mp_scanned += scanned;
+	mp_reclaimed += reclaimed;
+	if (mp_scanned < MEM_PRESSURE_WINDOW) {
+		spin_unlock(&mem_pressure_lock);
+		return;
+	}
+	/* slab pages freed along the way can make up for the LRU */
+	if (mp_reclaimed < mp_scanned)
+		pressure = 100 - mp_reclaimed * 100 / mp_scanned;
+	mp_scanned = 0;
+	mp_reclaimed = 0;
+	spin_unlock(&mem_pressure_lock);
+
+	if (pressure >= MEM_PRESSURE_CRITICAL_PCT)
+		level = MEM_PRESSURE_CRITICAL;
+	else if (pressure >= MEM_PRESSURE_MEDIUM_PCT)
+		level = MEM_PRESSURE_MEDIUM;
+	else
+		level = MEM_PRESSURE_LOW;
+	mem_pressure_event(level);
+}
+
+/* Called by direct reclaim each time it raises its scanning priority */
+void mem_pressure_prio(int priority)
+{
+	if (priority > MEM_PRESSURE_CRITICAL_PRIO)
+		return;
+
+	spin_lock(&mem_pressure_lock);
+	mp_scanned = 0;
+	mp_reclaimed = 0;
+	spin_unlock(&mem_pressure_lock);
+
+	mem_pressure_event(MEM_PRESSURE_CRITICAL);
+}
+
+/*
+ * Returns the highest level, at or above the file's minimum, at which an
+ * event happened since the file was last read, or -1.
+ */
+static int mem_pressure_pending(struct mem_pressure_file *mpf)
+{
+	int level;
+
+	spin_lock(&mem_pressure_lock);
+	for (level = MEM_PRESSURE_NR_LEVELS - 1; level >= mpf->min_level;
+	     level--) {
+		if (mpf->seen[level] != mp_events[level])
+			break;
+	}
+	spin_unlock(&mem_pressure_lock);
+
+	return level >= mpf->min_level ? level : -1;
+}
+
+static void mem_pressure_catch_up(struct mem_pressure_file *mpf)
+{
+	spin_lock(&mem_pressure_lock);
+	memcpy(mpf->seen, mp_events, sizeof(mpf->seen));
+	spin_unlock(&mem_pressure_lock);
+}
+
+static int mem_pressure_open(struct inode *inode, struct file *file)
+{
+	struct mem_pressure_file *mpf;
+	int ret;
+
+	ret = nonseekable_open(inode, file);
+	if (unlikely(ret))
+		return ret;
+
+	mpf = kzalloc(sizeof(*mpf), GFP_KERNEL);
+	if (unlikely(!mpf))
+		return -ENOMEM;
+
+	mem_pressure_catch_up(mpf);
+	file->private_data = mpf;
+	return 0;
+}
+
+static int mem_pressure_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+/*
+ * Read the highest level reached since the last read, as a line of
+ * text.  Blocks until there is one, unless the file is non-blocking.
+ */
+static ssize_t mem_pressure_read(struct file *file, char __user *buf,
+				 size_t len, loff_t *pos)
+{
+	struct mem_pressure_file *mpf = file->private_data;
+	char line[16];
+	size_t n;
+	int level;
+
+	if (file->f_flags & O_NONBLOCK) {
+		level = mem_pressure_pending(mpf);
+		if (level < 0)
+			return -EAGAIN;
+	} else if (wait_event_interruptible(mem_pressure_wait,
+			(level = mem_pressure_pending(mpf)) >= 0))
+		return -ERESTARTSYS;
+
+	/* A read that fails leaves the event pending */
+	n = scnprintf(line, sizeof(line), "%s\n", mem_pressure_names[level]);
+	if (len < n)
+		return -EINVAL;
+	if (copy_to_user(buf, line, n))
+		return -EFAULT;
+
+	mem_pressure_catch_up(mpf);
+	return n;
+}
+
+/* Write a level name to only be woken up at that level or above. */
+static ssize_t mem_pressure_write(struct file *file, const char __user *buf,
+				  size_t len, loff_t *pos)
+{
+	struct mem_pressure_file *mpf = file->private_data;
+	char name[16];
+	size_t n = min(len, sizeof(name) - 1);
+	int level;
+
+	if (copy_from_user(name, buf, n))
+		return -EFAULT;
+	name[n] = '\0';
+
+	for (level = 0; level < MEM_PRESSURE_NR_LEVELS; level++) {
+		if (sysfs_streq(name, mem_pressure_names[level])) {
+			mpf->min_level = level;
+			return len;
+		}
+	}
+	return -EINVAL;
+}
+
+static unsigned int mem_pressure_poll(struct file *file, poll_table *wait)
+{
+	struct mem_pressure_file *mpf = file->private_data;
+
+	poll_wait(file, &mem_pressure_wait, wait);
+
+	if (mem_pressure_pending(mpf) >= 0)
+		return POLLIN | POLLRDNORM;
+	return 0;
+}
+
+static const struct file_operations mem_pressure_fops = {
+	.owner = THIS_MODULE,
+	.open = mem_pressure_open,
+	.release = mem_pressure_release,
+	.read = mem_pressure_read,
+	.write = mem_pressure_write,
+	.poll = mem_pressure_poll,
+};
+
+static struct miscdevice mem_pressure_misc = {
+	.minor = MISC_DYNAMIC_MINOR,
+	.name = "mem_pressure",
+	.fops = &mem_pressure_fops,
+};
+
+static int __init mem_pressure_init(void)
+{
+	int ret;
+
+	ret = misc_register(&mem_pressure_misc);
+	if (unlikely(ret))
+		printk(KERN_ERR "mem_pressure: failed to register misc device\n");
+	return ret;
+}
+module_init(mem_pressure_init);
@@ -637,6 +637,56 @@ out_set_pte:
 	set_pte_at(dst_mm, addr, dst_pte, pte);
 }
 
+/*
+ * Lazy fork (PR_SET_LAZY_FORK): the ptes that a fault in the child would
+ * fill in again the same way are not copied.  These are the ptes of page
+ * cache pages in mappings with a ->fault handler, and those of the zero
+ * page.  Anonymous pages, swap and migration entries are still copied,
+ * and the child gets no pte table for a range that has none of them.
+ */
+static inline int lazy_fork(struct mm_struct *src_mm,
+			    struct vm_area_struct *vma)
+{
+	return test_bit(MMF_LAZY_FORK, &src_mm->flags) &&
+		!(vma->vm_flags & (VM_HUGETLB | VM_NONLINEAR | VM_PFNMAP |
+				   VM_INSERTPAGE | VM_MIXEDMAP));
+}
+
+static int lazy_fork_skip_pte(struct vm_area_struct *vma, unsigned long addr,
+			      pte_t pte)
+{
+	struct page *page;
+
+	if (!pte_present(pte))
+		return 0;
+	page = vm_normal_page(vma, addr, pte);
+	if (!page)
+		return is_zero_pfn(pte_pfn(pte));
+	return !PageAnon(page) && vma->vm_ops && vma->vm_ops->fault;
+}
+
+/*
+ * Whether any pte in [addr, end) must be copied.  The parent holds
+ * mmap_sem for writing, so no new anonymous page can show up here while
+ * we look without the pte lock.
+ */
+static int lazy_fork_needs_copy(pmd_t *pmd, struct vm_area_struct *vma,
+				unsigned long addr, unsigned long end)
+{
+	pte_t *orig_pte, *pte;
+	int ret = 0;
+
+	orig_pte = pte = pte_offset_map(pmd, addr);
+	do {
+		if (!pte_none(*pte) && !lazy_fork_skip_pte(vma, addr, *pte)) {
+			ret = 1;
+			break;
+		}
+	} while (pte++, addr += PAGE_SIZE, addr != end);
+	pte_unmap(orig_pte);
+	return ret;
+}
+
 static int copy_pte_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 		pmd_t *dst_pmd, pmd_t *src_pmd, struct vm_area_struct *vma,
 		unsigned long addr, unsigned long end)
@@ -645,6 +695,7 @@ static int copy_pte_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 	pte_t *src_pte, *dst_pte;
 	spinlock_t *src_ptl, *dst_ptl;
 	int progress = 0;
+	int lazy = lazy_fork(src_mm, vma);
 	int rss[2];
 
 again:
@@ -670,7 +721,8 @@ again:
 			    spin_needbreak(src_ptl) || spin_needbreak(dst_ptl))
 				break;
 		}
-		if (pte_none(*src_pte)) {
+		if (pte_none(*src_pte) ||
+		    (lazy && lazy_fork_skip_pte(vma, addr, *src_pte))) {
 			progress++;
 			continue;
 		}
@@ -695,6 +747,7 @@ static inline int copy_pmd_range(struct mm_struct *dst_mm, struct mm_struct *src
 {
 	pmd_t *src_pmd, *dst_pmd;
 	unsigned long next;
+	int lazy = lazy_fork(src_mm, vma);
 
 	dst_pmd = pmd_alloc(dst_mm, dst_pud, addr);
 	if (!dst_pmd)
@@ -704,6 +757,8 @@ static inline int copy_pmd_range(struct mm_struct *dst_mm, struct mm_struct *src
 		next = pmd_addr_end(addr, end);
 		if (pmd_none_or_clear_bad(src_pmd))
 			continue;
+		if (lazy && !lazy_fork_needs_copy(src_pmd, vma, addr, next))
+			continue;
 		if (copy_pte_range(dst_mm, src_mm, dst_pmd, src_pmd,
 						vma, addr, next))
 			return -ENOMEM;
@@ -1796,6 +1851,8 @@ int remap_pfn_range(struct vm_area_struct *vma, unsigned long addr,
 
 	if (err)
 		untrack_pfn_vma(vma, pfn, PAGE_ALIGN(size));
+	else
+		arch_map_pfn_range_large(vma, end - PAGE_ALIGN(size), end);
 
 	return err;
 }
@@ -48,6 +48,7 @@
 #include <linux/page_cgroup.h>
 #include <linux/debugobjects.h>
 #include <linux/kmemleak.h>
+#include <linux/compaction.h>
 #include <trace/events/kmem.h>
 
 #include <asm/tlbflush.h>
@@ -1172,6 +1173,51 @@ void split_page(struct page *page, unsigned int order)
 		set_page_refcounted(page + i);
 }
 
+/*
+ * Similar to split_page except the page is already free. As this is only
+ * being used for migration, the migratetype of the block also changes.
+ * As this is called with interrupts disabled, the caller is responsible
+ * for calling arch_alloc_page() and kernel_map_page() after interrupts
+ * are enabled.
+ *
+ * Note: this is probably too low level an operation for use in drivers.
+ * Please consult with lkml before using this in your driver.
+ */
+int split_free_page(struct page *page)
+{
+	unsigned int order;
+	unsigned long watermark;
+	struct zone *zone;
+
+	BUG_ON(!PageBuddy(page));
+
+	zone = page_zone(page);
+	order = page_order(page);
+
+	/* Obey watermarks as if the page was being allocated */
+	watermark = low_wmark_pages(zone) + (1 << order);
+	if (!zone_watermark_ok(zone, 0, watermark, 0, 0))
+		return 0;
+
+	/* Remove page from free list */
+	list_del(&page->lru);
+	zone->free_area[order].nr_free--;
+	rmv_page_order(page);
+	__mod_zone_page_state(zone, NR_FREE_PAGES, -(1UL << order));
+
+	/* Split into individual pages */
+	set_page_refcounted(page);
+	split_page(page, order);
+
+	if (order >= pageblock_order - 1) {
+		struct page *endpage = page + (1 << order) - 1;
+		for (; page < endpage; page += pageblock_nr_pages)
+			set_pageblock_migratetype(page, MIGRATE_MOVABLE);
+	}
+
+	return 1 << order;
+}
+
 /*
  * Really, prep_compound_page() should be called from __rmqueue_bulk().  But
  * we cheat by calling it from here, in the order > 0 path.  Saves a branch
@@ -1672,6 +1718,62 @@ out:
 	return page;
 }
 
+#ifdef CONFIG_COMPACTION
+/* Try memory compaction for high-order allocations before reclaim */
+static struct page *
+__alloc_pages_direct_compact(gfp_t gfp_mask, unsigned int order,
+	struct zonelist *zonelist, enum zone_type high_zoneidx,
+	nodemask_t *nodemask, int alloc_flags, struct zone *preferred_zone,
+	int migratetype, unsigned long *did_some_progress)
+{
+	struct page *page;
+
+	if (!order || compaction_deferred(preferred_zone))
+		return NULL;
+
+	*did_some_progress = try_to_compact_pages(zonelist, order, gfp_mask,
+								nodemask);
+	if (*did_some_progress != COMPACT_SKIPPED) {
+
+		/* Page migration frees to the PCP lists but we want merging */
+		drain_pages(get_cpu());
+		put_cpu();
+
+		page = get_page_from_freelist(gfp_mask, nodemask,
+				order, zonelist, high_zoneidx,
+				alloc_flags, preferred_zone,
+				migratetype);
+		if (page) {
+			preferred_zone->compact_considered = 0;
+			preferred_zone->compact_defer_shift = 0;
+			count_vm_event(COMPACTSUCCESS);
+			return page;
+		}
+
+		/*
+		 * It's bad if compaction run occurs and fails.
+		 * The most likely reason is that pages exist,
+		 * but not enough to satisfy watermarks.
+		 */
+		count_vm_event(COMPACTFAIL);
+		defer_compaction(preferred_zone);
+
+		cond_resched();
+	}
+
+	return NULL;
+}
+#else
+static inline struct page *
+__alloc_pages_direct_compact(gfp_t gfp_mask, unsigned int order,
+	struct zonelist *zonelist, enum zone_type high_zoneidx,
+	nodemask_t *nodemask, int alloc_flags, struct zone *preferred_zone,
+	int migratetype, unsigned long *did_some_progress)
+{
+	return NULL;
+}
+#endif /* CONFIG_COMPACTION */
+
 /* The really slow allocator path where we enter direct reclaim */
 static inline struct page *
 __alloc_pages_direct_reclaim(gfp_t gfp_mask, unsigned int order,
@@ -1858,6 +1960,15 @@ rebalance:
 	if (test_thread_flag(TIF_MEMDIE) && !(gfp_mask & __GFP_NOFAIL))
 		goto nopage;
 
+	/* Try direct compaction */
+	page = __alloc_pages_direct_compact(gfp_mask, order,
+					zonelist, high_zoneidx,
+					nodemask,
+					alloc_flags, preferred_zone,
+					migratetype, &did_some_progress);
+	if (page)
+		goto got_pg;
+
 	/* Try direct reclaim and then allocating */
 	page = __alloc_pages_direct_reclaim(gfp_mask, order,
 					zonelist, high_zoneidx,
@@ -1968,6 +2079,140 @@ __alloc_pages_nodemask(gfp_t gfp_mask, unsigned int order,
 }
 EXPORT_SYMBOL(__alloc_pages_nodemask);
 
+/*
+ * Interrupts are disabled while zone->lock is held, so a bulk allocation
+ * takes at most this many pages from the buddy lists per lock hold.
+ */
+#define ALLOC_BULK_BATCH	256
+
+/**
+ * __alloc_pages_bulk - allocate a number of order-0 pages
+ * @gfp_mask: GFP flags for the allocation
+ * @nid: preferred node, or -1 for the current one
+ * @nr_pages: number of pages wanted
+ * @page_list: list to add the pages to, or NULL
+ * @page_array: array to store the pages in, if @page_list is NULL
+ *
+ * The pages come from the first zone that stays above its low watermark
+ * with all of them taken.  The per-cpu list of that zone is used up
+ * first and the rest is taken from the buddy lists, ALLOC_BULK_BATCH
+ * pages per hold of zone->lock, instead of one pcp->batch refill per
+ * few pages allocated.
+ *
+ * If no zone has enough free memory, a single page is allocated through
+ * the usual path, which may reclaim.  Callers that need all the pages
+ * should call again for the rest.
+ *
+ * Returns the number of pages allocated.  They are at the tail of
+ * @page_list, or in @page_array[0] onwards.  0 means that not even one
+ * page could be allocated.
+ */
+unsigned long __alloc_pages_bulk(gfp_t gfp_mask, int nid,
+			unsigned long nr_pages, struct list_head *page_list,
+			struct page **page_array)
+{
+	enum zone_type high_zoneidx = gfp_zone(gfp_mask);
+	int migratetype = allocflags_to_migratetype(gfp_mask);
+	int cold = !!(gfp_mask & __GFP_COLD);
+	struct zonelist *zonelist;
+	struct zone *preferred_zone, *zone;
+	struct per_cpu_pages *pcp;
+	struct list_head *list;
+	struct zoneref *z;
+	struct page *page, *next;
+	unsigned long flags, nr = 0, got;
+	LIST_HEAD(pages);
+
+	if (!nr_pages)
+		return 0;
+
+	gfp_mask &= gfp_allowed_mask;
+	might_sleep_if(gfp_mask & __GFP_WAIT);
+
+	if (nid < 0)
+		nid = numa_node_id();
+	zonelist = node_zonelist(nid, gfp_mask);
+
+	if (nr_pages == 1 || should_fail_alloc_page(gfp_mask, 0))
+		goto single;
+
+	first_zones_zonelist(zonelist, high_zoneidx, NULL, &preferred_zone);
+	if (!preferred_zone)
+		return 0;
+
+	for_each_zone_zonelist(zone, z, zonelist, high_zoneidx) {
+		unsigned long mark = low_wmark_pages(zone) + nr_pages;
+
+		if (!cpuset_zone_allowed_softwall(zone, gfp_mask))
+			continue;
+		if (zone_watermark_ok(zone, 0, mark, zone_idx(preferred_zone),
+				      ALLOC_WMARK_LOW | ALLOC_CPUSET))
+			break;
+	}
+	if (!zone)
+		goto single;
+
+	pcp = &zone_pcp(zone, get_cpu())->pcp;
+	list = &pcp->lists[migratetype];
+	local_irq_save(flags);
+	while (nr < nr_pages && !list_empty(list)) {
+		if (cold)
+			page = list_entry(list->prev, struct page, lru);
+		else
+			page = list_entry(list->next, struct page, lru);
+		list_move_tail(&page->lru, &pages);
+		pcp->count--;
+		nr++;
+	}
+	while (nr < nr_pages) {
+		unsigned long count = min(nr_pages - nr,
+					  (unsigned long)ALLOC_BULK_BATCH);
+
+		got = rmqueue_bulk(zone, 0, count, pages.prev,
+				   migratetype, cold);
+		nr += got;
+		if (got < count)
+			break;
+		if (nr < nr_pages) {
+			/* Let pending interrupts in between batches */
+			local_irq_restore(flags);
+			local_irq_save(flags);
+		}
+	}
+	__count_zone_vm_events(PGALLOC, zone, nr);
+	for (got = 0; got < nr; got++)
+		zone_statistics(preferred_zone, zone);
+	local_irq_restore(flags);
+	put_cpu();
+
+	nr = 0;
+	list_for_each_entry_safe(page, next, &pages, lru) {
+		list_del(&page->lru);
+		VM_BUG_ON(bad_range(zone, page));
+		if (prep_new_page(page, 0, gfp_mask))
+			continue;
+		trace_mm_page_alloc(page, 0, gfp_mask, migratetype);
+		if (page_list)
+			list_add_tail(&page->lru, page_list);
+		else
+			page_array[nr] = page;
+		nr++;
+	}
+	if (nr)
+		return nr;
+
+single:
+	page = __alloc_pages_nodemask(gfp_mask, 0, zonelist, NULL);
+	if (!page)
+		return 0;
+	if (page_list)
+		list_add_tail(&page->lru, page_list);
+	else
+		page_array[0] = page;
+	return 1;
+}
+EXPORT_SYMBOL(__alloc_pages_bulk);
+
 /*
  * Common helper functions.
  */
@@ -16,6 +16,9 @@
 #include <linux/task_io_accounting_ops.h>
 #include <linux/pagevec.h>
 #include <linux/pagemap.h>
+#include <linux/uaccess.h>
+
+#include "internal.h"
 
 /*
  * Initialise a struct file's readahead state.  Assumes that the caller has
@@ -170,7 +173,7 @@ __do_page_cache_readahead(struct address_space *mapping, struct file *filp,
 		rcu_read_lock();
 		page = radix_tree_lookup(&mapping->page_tree, page_offset);
 		rcu_read_unlock();
-		if (page)
+		if (page && !radix_tree_exceptional_entry(page))
 			continue;
 
 		page = page_cache_alloc_cold(mapping);
@@ -549,3 +552,236 @@ page_cache_async_readahead(struct address_space *mapping,
 	ondemand_readahead(mapping, ra, filp, true, offset, req_size);
 }
 EXPORT_SYMBOL_GPL(page_cache_async_readahead);
+
+#ifdef CONFIG_READAHEAD_TRACE
+/*
+ * Recorded readahead.
+ *
+ * The on-demand heuristics above are built for streaming and do badly
+ * on the scattered reads an application makes into large zip and dex
+ * files while it starts up: the window is either too small to help or
+ * reads data that is never used.  Instead, the accesses to a file can be
+ * recorded once (POSIX_FADV_RECORD), fetched by userspace as a list of
+ * extents (FS_IOC_RATRACE_GET) and saved, then replayed as one batch of
+ * reads before the accesses happen next time (FS_IOC_RATRACE_REPLAY).
+ */
+
+/* 128MB worth of 4k pages, so that the bitmap fits in a page. */
+#define RA_TRACE_MAX_PAGES	(PAGE_SIZE * BITS_PER_BYTE)
+#define RA_TRACE_MAX_EXTENTS	4096
+#define RA_TRACE_BATCH		((2 * 1024 * 1024) / PAGE_CACHE_SIZE)
+
+struct ra_trace_state {
+	pgoff_t start;			/* page index of bit 0 */
+	unsigned long nr_pages;		/* number of bits in bitmap */
+	unsigned long bitmap[0];
+};
+
+/**
+ * ra_trace_start - start recording the accesses to a file
+ * @filp: file to record
+ * @start: first page to record
+ * @end: last page to record, inclusive
+ *
+ * Only the first RA_TRACE_MAX_PAGES pages from @start are recorded.  A
+ * recording already in progress on @filp is thrown away.
+ */
+int ra_trace_start(struct file *filp, pgoff_t start, pgoff_t end)
+{
+	struct ra_trace_state *trace, *old;
+	unsigned long nr_pages;
+	loff_t isize;
+
+	isize = i_size_read(filp->f_mapping->host);
+	if (!isize)
+		return -EINVAL;
+	if (end > ((isize - 1) >> PAGE_CACHE_SHIFT))
+		end = (isize - 1) >> PAGE_CACHE_SHIFT;
+	if (start > end)
+		return -EINVAL;
+
+	nr_pages = min_t(unsigned long, end - start + 1, RA_TRACE_MAX_PAGES);
+	trace = kzalloc(sizeof(*trace) +
+			BITS_TO_LONGS(nr_pages) * sizeof(unsigned long),
+			GFP_KERNEL);
+	if (!trace)
+		return -ENOMEM;
+	trace->start = start;
+	trace->nr_pages = nr_pages;
+
+	spin_lock(&filp->f_lock);
+	old = filp->f_ra_trace;
+	filp->f_ra_trace = trace;
+	spin_unlock(&filp->f_lock);
+
+	kfree(old);
+	return 0;
+}
+
+void __ra_trace_record(struct file *filp, pgoff_t index)
+{
+	struct ra_trace_state *trace;
+
+	spin_lock(&filp->f_lock);
+	trace = filp->f_ra_trace;
+	if (trace && index - trace->start < trace->nr_pages)
+		__set_bit(index - trace->start, trace->bitmap);
+	spin_unlock(&filp->f_lock);
+}
+
+/*
+ * Called when the last reference to @filp goes away.
+ */
+void ra_trace_release(struct file *filp)
+{
+	kfree(filp->f_ra_trace);
+}
+
+/**
+ * ra_trace_get - hand the recorded accesses to userspace
+ * @filp: file being recorded
+ * @utrace: user buffer for up to @utrace->rt_count extents
+ *
+ * The number of extents in the trace is always returned in
+ * @utrace->rt_count.  If they all fit the recording ends, otherwise it
+ * goes on, so that the caller may size its buffer with a first call
+ * passing rt_count = 0.
+ */
+int ra_trace_get(struct file *filp, struct ra_trace __user *utrace)
+{
+	struct ra_trace_extent __user *uext = utrace->rt_extents;
+	struct ra_trace_state *trace;
+	struct ra_trace_extent ext;
+	unsigned long first, next;
+	u32 max, count = 0;
+	int ret = 0;
+
+	if (get_user(max, &utrace->rt_count))
+		return -EFAULT;
+
+	/*
+	 * Detach the trace, as copying it out may sleep; accesses made
+	 * meanwhile are not recorded.
+	 */
+	spin_lock(&filp->f_lock);
+	trace = filp->f_ra_trace;
+	filp->f_ra_trace = NULL;
+	spin_unlock(&filp->f_lock);
+	if (!trace)
+		return -EINVAL;
+
+	first = find_first_bit(trace->bitmap, trace->nr_pages);
+	while (first < trace->nr_pages) {
+		next = find_next_zero_bit(trace->bitmap, trace->nr_pages,
+					  first);
+		if (count < max) {
+			ext.re_start = (u64)(trace->start + first) <<
+						PAGE_CACHE_SHIFT;
+			ext.re_length = (u64)(next - first) << PAGE_CACHE_SHIFT;
+			if (copy_to_user(uext + count, &ext, sizeof(ext))) {
+				ret = -EFAULT;
+				break;
+			}
+		}
+		count++;
+		first = find_next_bit(trace->bitmap, trace->nr_pages, next);
+	}
+
+	if (!ret && put_user(count, &utrace->rt_count))
+		ret = -EFAULT;
+
+	if (ret || count > max) {
+		spin_lock(&filp->f_lock);
+		if (!filp->f_ra_trace) {
+			filp->f_ra_trace = trace;
+			trace = NULL;
+		}
+		spin_unlock(&filp->f_lock);
+	}
+
+	kfree(trace);
+	return ret;
+}
+
+/**
+ * ra_trace_replay - read in the extents of a recorded trace
+ * @filp: file to read
+ * @utrace: extents, as returned by ra_trace_get()
+ *
+ * Pages not yet cached are allocated for all the extents and submitted
+ * together, in batches of RA_TRACE_BATCH pages, so that the filesystem
+ * and the I/O scheduler see the whole set at once instead of one
+ * faulting page at a time.  Like POSIX_FADV_WILLNEED, this does not wait
+ * for the reads to complete.
+ */
+int ra_trace_replay(struct file *filp, struct ra_trace __user *utrace)
+{
+	struct address_space *mapping = filp->f_mapping;
+	struct ra_trace_extent __user *uext = utrace->rt_extents;
+	struct ra_trace_extent ext;
+	unsigned long budget, nr = 0;
+	pgoff_t index, end, last;
+	LIST_HEAD(page_pool);
+	struct page *page;
+	loff_t isize;
+	u32 i, count;
+	int ret = 0;
+
+	if (unlikely(!mapping->a_ops->readpage && !mapping->a_ops->readpages))
+		return -EINVAL;
+
+	if (get_user(count, &utrace->rt_count))
+		return -EFAULT;
+	if (count > RA_TRACE_MAX_EXTENTS)
+		return -EINVAL;
+
+	isize = i_size_read(mapping->host);
+	if (!isize)
+		return 0;
+	last = (isize - 1) >> PAGE_CACHE_SHIFT;
+	budget = max_sane_readahead(ULONG_MAX);
+
+	for (i = 0; i < count && budget; i++) {
+		if (copy_from_user(&ext, uext + i, sizeof(ext))) {
+			ret = -EFAULT;
+			break;
+		}
+		if (!ext.re_length || ext.re_start >= isize)
+			continue;
+
+		index = ext.re_start >> PAGE_CACHE_SHIFT;
+		end = last;
+		if (ext.re_length <= isize - ext.re_start)
+			end = (ext.re_start + ext.re_length - 1) >>
+							PAGE_CACHE_SHIFT;
+
+		for (; index <= end && budget; index++) {
+			rcu_read_lock();
+			page = radix_tree_lookup(&mapping->page_tree, index);
+			rcu_read_unlock();
+			if (page && !radix_tree_exceptional_entry(page))
+				continue;
+
+			page = page_cache_alloc_cold(mapping);
+			if (!page) {
+				budget = 0;
+				break;
+			}
+			page->index = index;
+			list_add(&page->lru, &page_pool);
+			budget--;
+
+			if (++nr == RA_TRACE_BATCH) {
+				read_pages(mapping, filp, &page_pool, nr);
+				nr = 0;
+			}
+		}
+	}
+
+	if (nr)
+		read_pages(mapping, filp, &page_pool, nr);
+	BUG_ON(!list_empty(&page_pool));
+
+	return ret;
+}
+#endif /* CONFIG_READAHEAD_TRACE */
@@ -171,7 +171,8 @@ void anon_vma_unlink(struct vm_area_struct *vma)
 	list_del(&vma->anon_vma_node);
 
 	/* We must garbage collect the anon_vma if it's empty */
-	empty = list_empty(&anon_vma->head);
+	empty = list_empty(&anon_vma->head) &&
+		!anon_vma_migrate_refcount(anon_vma);
 	spin_unlock(&anon_vma->lock);
 
 	if (empty)
@@ -184,6 +185,9 @@ static void anon_vma_ctor(void *data)
 
 	spin_lock_init(&anon_vma->lock);
 	INIT_LIST_HEAD(&anon_vma->head);
+#ifdef CONFIG_MIGRATION
+	atomic_set(&anon_vma->migrate_refcount, 0);
+#endif
 }
 
 void __init anon_vma_init(void)
@@ -222,6 +226,37 @@ void page_unlock_anon_vma(struct anon_vma *anon_vma)
 	rcu_read_unlock();
 }
 
+#ifdef CONFIG_MIGRATION
+/*
+ * Take a reference on the anon_vma of a mapped anonymous page, so that it
+ * stays around while the page is unmapped for migration, even if all of
+ * its vmas go away.  Returns NULL if the page is no longer mapped.
+ */
+struct anon_vma *page_get_anon_vma(struct page *page)
+{
+	struct anon_vma *anon_vma;
+
+	anon_vma = page_lock_anon_vma(page);
+	if (anon_vma) {
+		atomic_inc(&anon_vma->migrate_refcount);
+		page_unlock_anon_vma(anon_vma);
+	}
+	return anon_vma;
+}
+
+void drop_anon_vma(struct anon_vma *anon_vma)
+{
+	if (atomic_dec_and_lock(&anon_vma->migrate_refcount,
+				&anon_vma->lock)) {
+		int empty = list_empty(&anon_vma->head);
+
+		spin_unlock(&anon_vma->lock);
+		if (empty)
+			anon_vma_free(anon_vma);
+	}
+}
+#endif
+
 /*
  * At what user virtual address is page expected in @vma?
  * Returns virtual address or -EFAULT if page's index/offset is not
@@ -1010,6 +1045,20 @@ static int try_to_mlock_page(struct page *page, struct vm_area_struct *vma)
  * vm_flags for that VMA.  That should be OK, because that vma shouldn't be
  * 'LOCKED.
  */
+static bool is_vma_temporary_stack(struct vm_area_struct *vma)
+{
+	int maybe_stack = vma->vm_flags & (VM_GROWSDOWN | VM_GROWSUP);
+
+	if (!maybe_stack)
+		return false;
+
+	if ((vma->vm_flags & VM_STACK_INCOMPLETE_SETUP) ==
+						VM_STACK_INCOMPLETE_SETUP)
+		return true;
+
+	return false;
+}
+
 static int try_to_unmap_anon(struct page *page, enum ttu_flags flags)
 {
 	struct anon_vma *anon_vma;
@@ -1026,6 +1075,16 @@ static int try_to_unmap_anon(struct page *page, enum ttu_flags flags)
 		return ret;
 
 	list_for_each_entry(vma, &anon_vma->head, anon_vma_node) {
+		/*
+		 * During exec, a temporary stack vma is set up and later
+		 * moved.  It is moved under the anon_vma lock but its page
+		 * tables are not, so migration could miss its own migration
+		 * ptes.  Rather than make exec() take more locks, migration
+		 * leaves these vmas alone until exec() is done.
+		 */
+		if (PAGE_MIGRATION && TTU_ACTION(flags) == TTU_MIGRATION &&
+		    is_vma_temporary_stack(vma))
+			continue;
 		if (MLOCK_PAGES && unlikely(unlock)) {
 			if (!((vma->vm_flags & VM_LOCKED) &&
 			      page_mapped_in_vma(page, vma)))
@@ -376,6 +376,7 @@ static void kmem_list3_init(struct kmem_list3 *parent)
 	} while (0)
 
 #define CFLGS_OFF_SLAB		(0x80000000UL)
+#define CFLGS_NAME_COPY		(0x40000000UL)	/* name was kstrdup()ed */
 #define	OFF_SLAB(x)	((x)->flags & CFLGS_OFF_SLAB)
 
 #define BATCHREFILL_LIMIT	16
@@ -431,6 +432,14 @@ static void kmem_list3_init(struct kmem_list3 *parent)
 #define STATS_INC_FREEMISS(x)	do { } while (0)
 #endif
 
+#ifdef CONFIG_SLAB_LEAN
+#define LEAN_INC_MISS(x)	((x)->lean_misses++)
+#define cache_users(x)		((x)->refcount)
+#else
+#define LEAN_INC_MISS(x)	do { } while (0)
+#define cache_users(x)		1
+#endif
+
 #if DEBUG
 
 /*
@@ -860,6 +869,8 @@ static void next_reap_node(void)
  * Add the CPU number into the expiration time to minimize the possibility of
  * the CPUs getting into lockstep and contending for the global cache chain
  * lock.
+ * With CONFIG_SLAB_LEAN the timer is deferrable: an idle CPU is not woken
+ * up just to trim its queues, which are reaped when it next wakes.
  */
 static void __cpuinit start_cpu_timer(int cpu)
 {
@@ -872,7 +883,11 @@ static void __cpuinit start_cpu_timer(int cpu)
 	 */
 	if (keventd_up() && reap_work->work.func == NULL) {
 		init_reap_node(cpu);
+#ifdef CONFIG_SLAB_LEAN
+		INIT_DELAYED_WORK_DEFERRABLE(reap_work, cache_reap);
+#else
 		INIT_DELAYED_WORK(reap_work, cache_reap);
+#endif
 		schedule_delayed_work_on(cpu, reap_work,
 					__round_jiffies_relative(HZ, cpu));
 	}
@@ -1917,6 +1932,9 @@ static void __kmem_cache_destroy(struct kmem_cache *cachep)
 	for_each_online_cpu(i)
 	    kfree(cachep->array[i]);
 
+	if (cachep->flags & CFLGS_NAME_COPY)
+		kfree(cachep->name);
+
 	/* NUMA: free the list3 structures */
 	for_each_online_node(i) {
 		l3 = cachep->nodelists[i];
@@ -2054,6 +2072,66 @@ static int __init_refok setup_cpu_cache(struct kmem_cache *cachep, gfp_t gfp)
 	return 0;
 }
 
+#ifdef CONFIG_SLAB_LEAN
+/*
+ * Caches that need neither a constructor nor debugging, and whose objects
+ * have the same size and a compatible alignment, are merged:
+ * kmem_cache_create() returns the existing cache with one more user.
+ */
+#define SLAB_NEVER_MERGE	(SLAB_RED_ZONE | SLAB_POISON | SLAB_STORE_USER | \
+				 SLAB_TRACE | SLAB_DESTROY_BY_RCU | \
+				 SLAB_NOLEAKTRACE)
+#define SLAB_MERGE_SAME		(SLAB_RECLAIM_ACCOUNT | SLAB_CACHE_DMA | \
+				 SLAB_MEM_SPREAD | SLAB_DEBUG_OBJECTS | \
+				 SLAB_NOTRACK)
+
+static int slab_nomerge;
+
+static int __init setup_slab_nomerge(char *str)
+{
+	slab_nomerge = 1;
+	return 1;
+}
+__setup("slab_nomerge", setup_slab_nomerge);
+
+/* Called with cache_chain_mutex held */
+static struct kmem_cache *find_mergeable(size_t size, size_t align,
+		unsigned long flags, void (*ctor)(void *))
+{
+	struct kmem_cache *pc;
+	char *name;
+
+	if (slab_nomerge || ctor || (flags & SLAB_NEVER_MERGE) ||
+	    g_cpucache_up != FULL)
+		return NULL;
+
+	size = ALIGN(size, align);
+	list_for_each_entry(pc, &cache_chain, next) {
+		if (pc == &cache_cache || pc->ctor ||
+		    (pc->flags & SLAB_NEVER_MERGE))
+			continue;
+		if (pc->buffer_size != size || (pc->align & (align - 1)))
+			continue;
+		if ((pc->flags & SLAB_MERGE_SAME) != (flags & SLAB_MERGE_SAME))
+			continue;
+
+		/*
+		 * The name belongs to the first user, which may be a module
+		 * that goes away while the others still use the cache.
+		 */
+		if (!(pc->flags & CFLGS_NAME_COPY)) {
+			name = kstrdup(pc->name, GFP_KERNEL);
+			if (!name)
+				return NULL;
+			pc->name = name;
+			pc->flags |= CFLGS_NAME_COPY;
+		}
+		return pc;
+	}
+	return NULL;
+}
+#endif
+
 /**
  * kmem_cache_create - Create a cache.
  * @name: A string which is used in /proc/slabinfo to identify this cache.
@@ -2217,6 +2295,14 @@ kmem_cache_create (const char *name, size_t size, size_t align,
 	 */
 	align = ralign;
 
+#ifdef CONFIG_SLAB_LEAN
+	cachep = find_mergeable(size, align, flags, ctor);
+	if (cachep) {
+		cachep->refcount++;
+		goto oops;
+	}
+#endif
+
 	if (slab_is_available())
 		gfp = GFP_KERNEL;
 	else
@@ -2334,6 +2420,10 @@ kmem_cache_create (const char *name, size_t size, size_t align,
 	}
 	cachep->ctor = ctor;
 	cachep->name = name;
+#ifdef CONFIG_SLAB_LEAN
+	cachep->refcount = 1;
+	cachep->align = align;
+#endif
 
 	if (setup_cpu_cache(cachep, gfp)) {
 		__kmem_cache_destroy(cachep);
@@ -2534,6 +2624,14 @@ void kmem_cache_destroy(struct kmem_cache *cachep)
 	/* Find the cache in the chain of caches. */
 	get_online_cpus();
 	mutex_lock(&cache_chain_mutex);
+#ifdef CONFIG_SLAB_LEAN
+	/* A merged cache stays until its last user destroys it. */
+	if (--cachep->refcount > 0) {
+		mutex_unlock(&cache_chain_mutex);
+		put_online_cpus();
+		return;
+	}
+#endif
 	/*
 	 * the chain is never empty, cache_cache is never destroyed
 	 */
@@ -3102,6 +3200,7 @@ static inline void *____cache_alloc(struct kmem_cache *cachep, gfp_t flags)
 		objp = ac->entry[--ac->avail];
 	} else {
 		STATS_INC_ALLOCMISS(cachep);
+		LEAN_INC_MISS(cachep);
 		objp = cache_alloc_refill(cachep, flags);
 	}
 	/*
@@ -3534,6 +3633,7 @@ static inline void __cache_free(struct kmem_cache *cachep, void *objp)
 		return;
 	} else {
 		STATS_INC_FREEMISS(cachep);
+		LEAN_INC_MISS(cachep);
 		cache_flusharray(cachep, ac);
 		ac->entry[ac->avail++] = objp;
 	}
@@ -3979,6 +4079,18 @@ static int enable_cpucache(struct kmem_cache *cachep, gfp_t gfp)
 	 */
 	if (limit > 32)
 		limit = 32;
+#endif
+#ifdef CONFIG_SLAB_LEAN
+	/*
+	 * Start with a quarter of the usual queue; cache_reap() grows it
+	 * back for the caches that keep missing in it.  The shared array
+	 * only helps objects that are freed on another CPU than the one
+	 * they came from, which is not worth its memory here.
+	 */
+	cachep->max_limit = limit;
+	cachep->min_limit = min(limit, max(limit / 4, 4));
+	limit = cachep->min_limit;
+	shared = 0;
 #endif
 	err = do_tune_cpucache(cachep, limit, (limit + 1) / 2, shared, gfp);
 	if (err)
@@ -4016,6 +4128,38 @@ void drain_array(struct kmem_cache *cachep, struct kmem_list3 *l3,
 	}
 }
 
+#ifdef CONFIG_SLAB_LEAN
+/*
+ * The per cpu queues of a cache that missed in them more than
+ * LEAN_GROW_MISSES times since the last check are doubled, up to the size
+ * SLAB would normally use.  Those of a cache that did not miss at all are
+ * halved, down to the size they started with.
+ */
+#define LEAN_GROW_MISSES	8
+
+/* Called with cache_chain_mutex held */
+static void lean_tune_cpucache(struct kmem_cache *cachep)
+{
+	unsigned int misses = cachep->lean_misses;
+	unsigned int limit = cachep->limit;
+
+	cachep->lean_misses = 0;
+	if (misses > LEAN_GROW_MISSES)
+		limit = min(limit * 2, cachep->max_limit);
+	else if (!misses)
+		limit = max(limit / 2, cachep->min_limit);
+	if (limit == cachep->limit)
+		return;
+
+	do_tune_cpucache(cachep, limit, (limit + 1) / 2, cachep->shared,
+			 GFP_NOWAIT | __GFP_NOWARN);
+}
+#else
+static inline void lean_tune_cpucache(struct kmem_cache *cachep)
+{
+}
+#endif
+
 /**
  * cache_reap - Reclaim memory from caches.
  * @w: work descriptor
@@ -4064,6 +4208,8 @@ static void cache_reap(struct work_struct *w)
 
 		drain_array(searchp, l3, l3->shared, 0, node);
 
+		lean_tune_cpucache(searchp);
+
 		if (l3->free_touched)
 			l3->free_touched = 0;
 		else {
@@ -4288,6 +4434,12 @@ ssize_t slabinfo_write(struct file *file, const char __user * buffer,
 				res = do_tune_cpucache(cachep, limit,
 						       batchcount, shared,
 						       GFP_KERNEL);
+#ifdef CONFIG_SLAB_LEAN
+				/* a limit set by hand is not tuned */
+				if (!res)
+					cachep->min_limit =
+						cachep->max_limit = limit;
+#endif
 			}
 			break;
 		}
@@ -4311,6 +4463,81 @@ static const struct file_operations proc_slabinfo_operations = {
 	.release	= seq_release,
 };
 
+/*
+ * /proc/slab_waste: how much of the memory in the slabs of each cache does
+ * not hold an allocated object.  Objects waiting in the per cpu and shared
+ * queues count as wasted, like free objects and the unused end of a slab.
+ */
+static int slab_waste_show(struct seq_file *m, void *v)
+{
+	struct kmem_cache *cachep;
+	unsigned long total_kb = 0, total_waste_kb = 0;
+
+	seq_puts(m, "# name            <objsize> <inuse> <queued> <free> "
+		 "<users> <slab_kb> <waste_kb> <waste%>\n");
+
+	mutex_lock(&cache_chain_mutex);
+	list_for_each_entry(cachep, &cache_chain, next) {
+		unsigned long num_slabs = 0, free_objects = 0, queued = 0;
+		unsigned long inuse, slab_kb, waste_kb;
+		struct kmem_list3 *l3;
+		struct slab *slabp;
+		int node, cpu;
+
+		for_each_online_node(node) {
+			l3 = cachep->nodelists[node];
+			if (!l3)
+				continue;
+
+			check_irq_on();
+			spin_lock_irq(&l3->list_lock);
+			list_for_each_entry(slabp, &l3->slabs_full, list)
+				num_slabs++;
+			list_for_each_entry(slabp, &l3->slabs_partial, list)
+				num_slabs++;
+			list_for_each_entry(slabp, &l3->slabs_free, list)
+				num_slabs++;
+			free_objects += l3->free_objects;
+			if (l3->shared)
+				queued += l3->shared->avail;
+			spin_unlock_irq(&l3->list_lock);
+		}
+		for_each_online_cpu(cpu) {
+			if (cachep->array[cpu])
+				queued += cachep->array[cpu]->avail;
+		}
+
+		inuse = num_slabs * cachep->num - free_objects;
+		inuse = inuse > queued ? inuse - queued : 0;
+		slab_kb = num_slabs << (cachep->gfporder + PAGE_SHIFT - 10);
+		waste_kb = slab_kb - ((inuse * cachep->buffer_size) >> 10);
+		total_kb += slab_kb;
+		total_waste_kb += waste_kb;
+
+		seq_printf(m, "%-17s %6u %7lu %6lu %6lu %3d %8lu %8lu %5lu\n",
+			   cachep->name, cachep->buffer_size, inuse, queued,
+			   free_objects, cache_users(cachep), slab_kb, waste_kb,
+			   slab_kb ? waste_kb * 100 / slab_kb : 0);
+	}
+	mutex_unlock(&cache_chain_mutex);
+
+	seq_printf(m, "# total %lu kB in slabs, %lu kB wasted\n",
+		   total_kb, total_waste_kb);
+	return 0;
+}
+
+static int slab_waste_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, slab_waste_show, NULL);
+}
+
+static const struct file_operations proc_slab_waste_operations = {
+	.open		= slab_waste_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 #ifdef CONFIG_DEBUG_SLAB_LEAK
 
 static void *leaks_start(struct seq_file *m, loff_t *pos)
@@ -4474,6 +4701,7 @@ static const struct file_operations proc_slabstats_operations = {
 static int __init slab_proc_init(void)
 {
 	proc_create("slabinfo",S_IWUSR|S_IRUGO,NULL,&proc_slabinfo_operations);
+	proc_create("slab_waste", S_IRUGO, NULL, &proc_slab_waste_operations);
 #ifdef CONFIG_DEBUG_SLAB_LEAK
 	proc_create("slab_allocators", 0, NULL, &proc_slabstats_operations);
 #endif
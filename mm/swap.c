@@ -38,6 +38,7 @@ int page_cluster;
 
 static DEFINE_PER_CPU(struct pagevec[NR_LRU_LISTS], lru_add_pvecs);
 static DEFINE_PER_CPU(struct pagevec, lru_rotate_pvecs);
+static DEFINE_PER_CPU(struct pagevec, activate_page_pvecs);
 
 /*
  * This path almost never happens for VM activity - pages are normally
@@ -171,14 +172,8 @@ static void update_page_reclaim_stat(struct zone *zone, struct page *page,
 		memcg_reclaim_stat->recent_rotated[file]++;
 }
 
-/*
- * FIXME: speed this up?
- */
-void activate_page(struct page *page)
+static void __activate_page(struct page *page, struct zone *zone)
 {
-	struct zone *zone = page_zone(page);
-
-	spin_lock_irq(&zone->lru_lock);
 	if (PageLRU(page) && !PageActive(page) && !PageUnevictable(page)) {
 		int file = page_is_file_cache(page);
 		int lru = page_lru_base_type(page);
@@ -190,8 +185,61 @@ void activate_page(struct page *page)
 		__count_vm_event(PGACTIVATE);
 
 		update_page_reclaim_stat(zone, page, file, 1);
+		if (file)
+			workingset_activation(page);
+	}
+}
+
+static void pagevec_activate(struct pagevec *pvec)
+{
+	int i;
+	struct zone *zone = NULL;
+
+	for (i = 0; i < pagevec_count(pvec); i++) {
+		struct page *page = pvec->pages[i];
+		struct zone *pagezone = page_zone(page);
+
+		if (pagezone != zone) {
+			if (zone)
+				spin_unlock_irq(&zone->lru_lock);
+			zone = pagezone;
+			spin_lock_irq(&zone->lru_lock);
+		}
+		__activate_page(page, zone);
+	}
+	if (zone)
+		spin_unlock_irq(&zone->lru_lock);
+	release_pages(pvec->pages, pvec->nr, pvec->cold);
+	pagevec_reinit(pvec);
+}
+
+/*
+ * Pages are activated in batches of PAGEVEC_SIZE per cpu, like they are
+ * added to the LRU: page cache reads on several CPUs call this through
+ * mark_page_accessed(), and would otherwise take zone->lru_lock for
+ * every page they activate.
+ *
+ * A queued page is not PageActive until the pagevec is drained, so
+ * mark_page_accessed() may send it again: it is not queued twice on the
+ * same cpu.  Should another cpu queue it as well, __activate_page() finds
+ * it active already and leaves it alone.
+ */
+void activate_page(struct page *page)
+{
+	if (PageLRU(page) && !PageActive(page) && !PageUnevictable(page)) {
+		struct pagevec *pvec = &get_cpu_var(activate_page_pvecs);
+		int i;
+
+		for (i = 0; i < pagevec_count(pvec); i++)
+			if (pvec->pages[i] == page)
+				break;
+		if (i == pagevec_count(pvec)) {
+			page_cache_get(page);
+			if (!pagevec_add(pvec, page))
+				pagevec_activate(pvec);
+		}
+		put_cpu_var(activate_page_pvecs);
 	}
-	spin_unlock_irq(&zone->lru_lock);
 }
 
 /*
@@ -290,6 +338,10 @@ static void drain_cpu_pagevecs(int cpu)
 		pagevec_move_tail(pvec);
 		local_irq_restore(flags);
 	}
+
+	pvec = &per_cpu(activate_page_pvecs, cpu);
+	if (pagevec_count(pvec))
+		pagevec_activate(pvec);
 }
 
 void lru_add_drain(void)
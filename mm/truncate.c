@@ -181,6 +181,41 @@ int invalidate_inode_page(struct page *page)
 	return invalidate_complete_page(mapping, page);
 }
 
+/*
+ * Remove the shadow entries that evicted pages left between @start and
+ * @end (see mm/workingset.c).  The indices are collected first, because
+ * radix_tree_delete() may free the nodes the slots point into.
+ */
+static void truncate_shadow_entries(struct address_space *mapping,
+				    pgoff_t start, pgoff_t end)
+{
+	void **slots[PAGEVEC_SIZE];
+	unsigned long indices[PAGEVEC_SIZE];
+	pgoff_t shadows[PAGEVEC_SIZE];
+	unsigned int nr_found, nr_shadows, i;
+
+	while (start <= end && mapping->nrshadows) {
+		spin_lock_irq(&mapping->tree_lock);
+		nr_found = radix_tree_gang_lookup_slot(&mapping->page_tree,
+				slots, indices, start, PAGEVEC_SIZE);
+		nr_shadows = 0;
+		for (i = 0; i < nr_found && indices[i] <= end; i++)
+			if (radix_tree_exceptional_entry(
+					radix_tree_deref_slot(slots[i])))
+				shadows[nr_shadows++] = indices[i];
+		for (i = 0; i < nr_shadows; i++) {
+			radix_tree_delete(&mapping->page_tree, shadows[i]);
+			mapping->nrshadows--;
+		}
+		spin_unlock_irq(&mapping->tree_lock);
+
+		if (nr_found < PAGEVEC_SIZE || indices[nr_found - 1] >= end)
+			break;
+		start = indices[nr_found - 1] + 1;
+		cond_resched();
+	}
+}
+
 /**
  * truncate_inode_pages - truncate range of pages specified by start & end byte offsets
  * @mapping: mapping to truncate
@@ -214,7 +249,7 @@ void truncate_inode_pages_range(struct address_space *mapping,
 	pgoff_t next;
 	int i;
 
-	if (mapping->nrpages == 0)
+	if (mapping->nrpages == 0 && mapping->nrshadows == 0)
 		return;
 
 	BUG_ON((lend & (PAGE_CACHE_SIZE - 1)) != (PAGE_CACHE_SIZE - 1));
@@ -287,6 +322,7 @@ void truncate_inode_pages_range(struct address_space *mapping,
 		}
 		pagevec_release(&pvec);
 	}
+	truncate_shadow_entries(mapping, start, end);
 }
 EXPORT_SYMBOL(truncate_inode_pages_range);
 
@@ -382,7 +418,7 @@ invalidate_complete_page2(struct address_space *mapping, struct page *page)
 
 	clear_page_mlock(page);
 	BUG_ON(page_has_private(page));
-	__remove_from_page_cache(page);
+	__remove_from_page_cache(page, NULL);
 	spin_unlock_irq(&mapping->tree_lock);
 	mem_cgroup_uncharge_cache_page(page);
 	page_cache_release(page);	/* pagecache ref */
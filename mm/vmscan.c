@@ -40,6 +40,7 @@
 #include <linux/memcontrol.h>
 #include <linux/delayacct.h>
 #include <linux/sysctl.h>
+#include <linux/mem_pressure.h>
 
 #include <asm/tlbflush.h>
 #include <asm/div64.h>
@@ -431,7 +432,8 @@ static pageout_t pageout(struct page *page, struct address_space *mapping,
  * Same as remove_mapping, but if the page is removed from the mapping, it
  * gets returned with a refcount of 0.
  */
-static int __remove_mapping(struct address_space *mapping, struct page *page)
+static int __remove_mapping(struct address_space *mapping, struct page *page,
+			    bool reclaimed)
 {
 	BUG_ON(!PageLocked(page));
 	BUG_ON(mapping != page_mapping(page));
@@ -476,7 +478,15 @@ static int __remove_mapping(struct address_space *mapping, struct page *page)
 		spin_unlock_irq(&mapping->tree_lock);
 		swapcache_free(swap, page);
 	} else {
-		__remove_from_page_cache(page);
+		void *shadow = NULL;
+
+		/*
+		 * Remember when a reclaimed file page was evicted, so that
+		 * a refault can tell whether it belongs to the working set.
+		 */
+		if (reclaimed && page_is_file_cache(page))
+			shadow = workingset_eviction(mapping, page);
+		__remove_from_page_cache(page, shadow);
 		spin_unlock_irq(&mapping->tree_lock);
 		mem_cgroup_uncharge_cache_page(page);
 	}
@@ -496,7 +506,7 @@ cannot_free:
  */
 int remove_mapping(struct address_space *mapping, struct page *page)
 {
-	if (__remove_mapping(mapping, page)) {
+	if (__remove_mapping(mapping, page, false)) {
 		/*
 		 * Unfreezing the refcount with 1 rather than 2 effectively
 		 * drops the pagecache ref for us without requiring another
@@ -758,7 +768,7 @@ static unsigned long shrink_page_list(struct list_head *page_list,
 			}
 		}
 
-		if (!mapping || !__remove_mapping(mapping, page))
+		if (!mapping || !__remove_mapping(mapping, page, true))
 			goto keep_locked;
 
 		/*
@@ -804,11 +814,6 @@ keep:
 	return nr_reclaimed;
 }
 
-/* LRU Isolation modes. */
-#define ISOLATE_INACTIVE 0	/* Isolate inactive pages. */
-#define ISOLATE_ACTIVE 1	/* Isolate active pages. */
-#define ISOLATE_BOTH 2		/* Isolate both active and inactive pages. */
-
 /*
  * Attempt to remove the specified page from its LRU.  Only take this page
  * if it is of the appropriate PageActive status.  Pages which are being
@@ -1744,6 +1749,7 @@ static unsigned long do_try_to_free_pages(struct zonelist *zonelist,
 	struct zoneref *z;
 	struct zone *zone;
 	enum zone_type high_zoneidx = gfp_zone(sc->gfp_mask);
+	ktime_t start = ktime_get();
 
 	delayacct_freepages_start();
 
@@ -1763,6 +1769,8 @@ static unsigned long do_try_to_free_pages(struct zonelist *zonelist,
 	}
 
 	for (priority = DEF_PRIORITY; priority >= 0; priority--) {
+		unsigned long nr_reclaimed = sc->nr_reclaimed;
+
 		sc->nr_scanned = 0;
 		if (!priority)
 			disable_swap_token();
@@ -1777,6 +1785,9 @@ static unsigned long do_try_to_free_pages(struct zonelist *zonelist,
 				sc->nr_reclaimed += reclaim_state->reclaimed_slab;
 				reclaim_state->reclaimed_slab = 0;
 			}
+			mem_pressure_account(sc->nr_scanned,
+					     sc->nr_reclaimed - nr_reclaimed);
+			mem_pressure_prio(priority);
 		}
 		total_scanned += sc->nr_scanned;
 		if (sc->nr_reclaimed >= sc->swap_cluster_max) {
@@ -1823,6 +1834,8 @@ out:
 
 			zone->prev_priority = priority;
 		}
+		count_vm_events(ALLOCSTALL_US,
+				ktime_us_delta(ktime_get(), start));
 	} else
 		mem_cgroup_record_reclaim_priority(sc->mem_cgroup, priority);
 
@@ -2022,6 +2035,7 @@ loop_again:
 		 */
 		for (i = 0; i <= end_zone; i++) {
 			struct zone *zone = pgdat->node_zones + i;
+			unsigned long nr_reclaimed = sc.nr_reclaimed;
 			int nr_slab;
 			int nid, zid;
 
@@ -2059,6 +2073,8 @@ loop_again:
 						lru_pages);
 			sc.nr_reclaimed += reclaim_state->reclaimed_slab;
 			total_scanned += sc.nr_scanned;
+			mem_pressure_account(sc.nr_scanned,
+					     sc.nr_reclaimed - nr_reclaimed);
 			if (zone_is_all_unreclaimable(zone))
 				continue;
 			if (nr_slab == 0 && zone->pages_scanned >=
@@ -2131,6 +2147,188 @@ out:
 	return sc.nr_reclaimed;
 }
 
+/*
+ * Soft reclaim.
+ *
+ * The low watermarks that wake kswapd sit far below the free memory
+ * levels at which the lowmemorykiller starts killing processes.  Once
+ * sysctl_soft_reclaim_free_kbytes is set above those levels, kswapd also
+ * wakes up every SOFT_RECLAIM_INTERVAL while free memory is below it,
+ * and frees up to sysctl_soft_reclaim_budget_kbytes per second of the
+ * cheapest memory there is: ashmem ranges that userspace unpinned, then
+ * clean and unmapped page cache.  Nothing is written back or unmapped, so
+ * this reclaim never blocks on I/O and never touches a page that a
+ * running application has mapped.
+ *
+ * The wakeups use a deferrable timer, so an idle system is not woken.
+ */
+#define SOFT_RECLAIM_INTERVAL	(HZ / 4)
+
+int sysctl_soft_reclaim_free_kbytes;
+int sysctl_soft_reclaim_budget_kbytes = 4096;
+
+static struct timer_list kswapd_soft_timer[MAX_NUMNODES];
+
+static void kswapd_soft_timeout(unsigned long data)
+{
+	wake_up_process((struct task_struct *)data);
+}
+
+static unsigned long soft_reclaim_free_pages(void)
+{
+	return sysctl_soft_reclaim_free_kbytes >> (PAGE_SHIFT - 10);
+}
+
+static int soft_reclaim_needed(void)
+{
+	return global_page_state(NR_FREE_PAGES) < soft_reclaim_free_pages();
+}
+
+/*
+ * Purge the shrinkers that opted in to soft reclaim.  Returns the number
+ * of objects (pages, for ashmem) they dropped.
+ */
+static unsigned long soft_shrink_slab(unsigned long nr_to_scan)
+{
+	struct shrinker *shrinker;
+	unsigned long freed = 0;
+
+	if (!down_read_trylock(&shrinker_rwsem))
+		return 0;
+
+	list_for_each_entry(shrinker, &shrinker_list, list) {
+		int before, after;
+
+		if (!shrinker->soft_reclaim || freed >= nr_to_scan)
+			continue;
+		before = (*shrinker->shrink)(0, GFP_KERNEL);
+		if (before <= 0)
+			continue;
+		after = (*shrinker->shrink)(nr_to_scan - freed, GFP_KERNEL);
+		if (after >= 0 && after < before)
+			freed += before - after;
+	}
+	up_read(&shrinker_rwsem);
+	return freed;
+}
+
+/*
+ * Free at most @nr_pages pages of @pgdat without writeback, unmapping or
+ * swap.  Returns the number of pages freed.
+ */
+static unsigned long soft_reclaim_pgdat(pg_data_t *pgdat,
+					unsigned long nr_pages)
+{
+	int priority;
+	int i;
+	struct scan_control sc = {
+		.gfp_mask = GFP_KERNEL,
+		.may_writepage = 0,
+		.may_unmap = 0,
+		.may_swap = 0,
+		.swap_cluster_max = SWAP_CLUSTER_MAX,
+		.swappiness = vm_swappiness,
+		.order = 0,
+		.mem_cgroup = NULL,
+		.isolate_pages = isolate_pages_global,
+	};
+
+	sc.nr_reclaimed = soft_shrink_slab(nr_pages);
+
+	/*
+	 * Scan gently: a few priority levels are enough to find the clean
+	 * pages at the tail of the file lists, and going further would
+	 * only cycle the working set through the active list.
+	 */
+	for (priority = DEF_PRIORITY;
+	     priority > DEF_PRIORITY - 4 && sc.nr_reclaimed < nr_pages;
+	     priority--) {
+		for (i = 0; i < pgdat->nr_zones; i++) {
+			struct zone *zone = pgdat->node_zones + i;
+
+			if (!populated_zone(zone) ||
+			    zone_is_all_unreclaimable(zone))
+				continue;
+
+			sc.nr_scanned = 0;
+			shrink_zone(priority, zone, &sc);
+			if (sc.nr_reclaimed >= nr_pages)
+				break;
+		}
+	}
+
+	count_vm_events(KSWAPD_SOFT_STEAL, sc.nr_reclaimed);
+	return sc.nr_reclaimed;
+}
+
+/*
+ * Called from kswapd woken up by its soft reclaim timer.  Free one
+ * interval's worth of the budget if free memory is below the soft
+ * watermark.  Returns 0 if a zone is below its low watermark, in which
+ * case the caller must balance the node as usual.
+ */
+static int kswapd_soft_reclaim(pg_data_t *pgdat)
+{
+	unsigned long budget;
+	int i;
+
+	for (i = 0; i < pgdat->nr_zones; i++) {
+		struct zone *zone = pgdat->node_zones + i;
+
+		if (populated_zone(zone) && !zone_watermark_ok(zone, 0,
+					low_wmark_pages(zone), 0, 0))
+			return 0;
+	}
+
+	if (!soft_reclaim_needed())
+		return 1;
+
+	budget = sysctl_soft_reclaim_budget_kbytes >> (PAGE_SHIFT - 10);
+	budget = budget * SOFT_RECLAIM_INTERVAL / HZ;
+	if (budget)
+		soft_reclaim_pgdat(pgdat, budget);
+	return 1;
+}
+
+/*
+ * Sleep until woken up by wakeup_kswapd(), or until the next soft reclaim
+ * interval if soft reclaim is enabled.  Returns 1 if the soft reclaim
+ * timer woke us up.
+ */
+static int kswapd_sleep(pg_data_t *pgdat)
+{
+	struct timer_list *timer = &kswapd_soft_timer[pgdat->node_id];
+
+	if (!sysctl_soft_reclaim_free_kbytes) {
+		schedule();
+		return 0;
+	}
+
+	mod_timer(timer, jiffies + SOFT_RECLAIM_INTERVAL);
+	schedule();
+	return !del_timer_sync(timer);
+}
+
+int soft_reclaim_sysctl_handler(struct ctl_table *table, int write,
+		void __user *buffer, size_t *length, loff_t *ppos)
+{
+	pg_data_t *pgdat;
+	int ret;
+
+	ret = proc_dointvec_minmax(table, write, buffer, length, ppos);
+	if (ret || !write || !sysctl_soft_reclaim_free_kbytes)
+		return ret;
+
+	/* kswapd may be asleep without a timer, give it one */
+	for_each_online_pgdat(pgdat) {
+		struct task_struct *tsk = pgdat->kswapd;
+
+		if (tsk)
+			wake_up_process(tsk);
+	}
+	return 0;
+}
+
 /*
  * The background pageout daemon, started as a kernel thread
  * from the init process.
@@ -2154,9 +2352,14 @@ static int kswapd(void *p)
 		.reclaimed_slab = 0,
 	};
 	const struct cpumask *cpumask = cpumask_of_node(pgdat->node_id);
+	struct timer_list *soft_timer = &kswapd_soft_timer[pgdat->node_id];
 
 	lockdep_set_current_reclaim_state(GFP_KERNEL);
 
+	init_timer_deferrable(soft_timer);
+	soft_timer->function = kswapd_soft_timeout;
+	soft_timer->data = (unsigned long)tsk;
+
 	if (!cpumask_empty(cpumask))
 		set_cpus_allowed_ptr(tsk, cpumask);
 	current->reclaim_state = &reclaim_state;
@@ -2179,6 +2382,7 @@ static int kswapd(void *p)
 	order = 0;
 	for ( ; ; ) {
 		unsigned long new_order;
+		int soft = 0;
 
 		prepare_to_wait(&pgdat->kswapd_wait, &wait, TASK_INTERRUPTIBLE);
 		new_order = pgdat->kswapd_max_order;
@@ -2191,7 +2395,7 @@ static int kswapd(void *p)
 			order = new_order;
 		} else {
 			if (!freezing(current))
-				schedule();
+				soft = kswapd_sleep(pgdat);
 
 			order = pgdat->kswapd_max_order;
 		}
@@ -2201,7 +2405,8 @@ static int kswapd(void *p)
 			/* We can speed up thawing tasks if we don't call
 			 * balance_pgdat after returning from the refrigerator
 			 */
-			balance_pgdat(pgdat, order);
+			if (!soft || order || !kswapd_soft_reclaim(pgdat))
+				balance_pgdat(pgdat, order);
 		}
 	}
 	return 0;
@@ -0,0 +1,130 @@
+/*
+ * mm/workingset.c
+ *
+ * Working set detection for the page cache.
+ *
+ * File pages start on the inactive list and are only activated when
+ * they are accessed a second time while still there.  A page that is
+ * used over and over, but less often than the inactive list takes to
+ * cycle, is evicted every time and never gets activated: a large
+ * sequential read then pushes out the working set of every running
+ * application.
+ *
+ * Each zone counts the file pages that leave its inactive list, either
+ * evicted or activated, in zone->inactive_age.  When reclaim evicts a
+ * page, the count is stored in the page's slot of the radix tree, as an
+ * exceptional "shadow" entry.  When the page is read in again, the
+ * difference between the count then and the one in the shadow is its
+ * refault distance: the number of pages that left the inactive list
+ * while it was out of memory.  Had the inactive list been that many
+ * pages longer, the page would have been accessed again before being
+ * evicted.  Pages can only be taken from the active list to make it
+ * longer, so a refaulting page whose distance is no longer than the
+ * active list is activated at once, to compete with the active pages.
+ * If the active pages are used more, the page will be deactivated and
+ * evicted again.  Pages that are read only once leave no shadow behind
+ * that is ever used, and keep being recycled from the inactive list.
+ *
+ * Shadow entries are removed when the page is read in again, when the
+ * file is truncated and when its inode is freed.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation.
+ */
+
+#include <linux/mm.h>
+#include <linux/fs.h>
+#include <linux/swap.h>
+#include <linux/vmstat.h>
+#include <linux/mmzone.h>
+#include <linux/radix-tree.h>
+
+#define EVICTION_SHIFT	(RADIX_TREE_EXCEPTIONAL_SHIFT + \
+			 NODES_SHIFT + ZONES_SHIFT)
+#define EVICTION_MASK	(~0UL >> EVICTION_SHIFT)
+
+static void *pack_shadow(unsigned long eviction, struct zone *zone)
+{
+	eviction = (eviction << NODES_SHIFT) | zone_to_nid(zone);
+	eviction = (eviction << ZONES_SHIFT) | zone_idx(zone);
+	eviction = (eviction << RADIX_TREE_EXCEPTIONAL_SHIFT);
+
+	return (void *)(eviction | RADIX_TREE_EXCEPTIONAL_ENTRY);
+}
+
+static void unpack_shadow(void *shadow, struct zone **zone,
+			  unsigned long *distance)
+{
+	unsigned long entry = (unsigned long)shadow;
+	unsigned long eviction, refault;
+	int zid;
+
+	entry >>= RADIX_TREE_EXCEPTIONAL_SHIFT;
+	zid = entry & ((1UL << ZONES_SHIFT) - 1);
+	entry >>= ZONES_SHIFT;
+	/* NODE_DATA() ignores the node id on UMA */
+	*zone = NODE_DATA(entry & ((1UL << NODES_SHIFT) - 1))->node_zones + zid;
+	entry >>= NODES_SHIFT;
+	eviction = entry;
+
+	/* The counter only has EVICTION_MASK bits and may have wrapped */
+	refault = atomic_long_read(&(*zone)->inactive_age);
+	*distance = (refault - eviction) & EVICTION_MASK;
+}
+
+/**
+ * workingset_eviction - note the eviction of a page from the page cache
+ * @mapping: address space the page was backing
+ * @page: the page being evicted
+ *
+ * Returns a shadow entry to be stored in the place of the page, or NULL.
+ * Called with the mapping's tree_lock held.
+ */
+void *workingset_eviction(struct address_space *mapping, struct page *page)
+{
+	struct zone *zone = page_zone(page);
+	unsigned long eviction;
+
+	/*
+	 * A refault distance can never be larger than memory, so more
+	 * shadow entries than that in one file are of no use.  This caps
+	 * the radix tree nodes they can pin until the file is truncated
+	 * or its inode freed.
+	 */
+	if (mapping->nrshadows >= totalram_pages)
+		return NULL;
+
+	eviction = atomic_long_inc_return(&zone->inactive_age);
+	return pack_shadow(eviction, zone);
+}
+
+/**
+ * workingset_refault - evaluate the refault of a previously evicted page
+ * @shadow: shadow entry of the evicted page
+ *
+ * Returns true if the page should be activated, because it would have
+ * stayed in memory with a shorter active list.
+ */
+bool workingset_refault(void *shadow)
+{
+	unsigned long refault_distance;
+	struct zone *zone;
+
+	unpack_shadow(shadow, &zone, &refault_distance);
+	inc_zone_state(zone, WORKINGSET_REFAULT);
+
+	if (refault_distance <= zone_page_state(zone, NR_ACTIVE_FILE)) {
+		inc_zone_state(zone, WORKINGSET_ACTIVATE);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * workingset_activation - note a page activation
+ * @page: page that is being activated
+ */
+void workingset_activation(struct page *page)
+{
+	atomic_long_inc(&page_zone(page)->inactive_age);
+}